@@ -0,0 +1,185 @@
+#include "differential.h"
+#include "equity.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+namespace Poker {
+	// utility
+
+	const size_t deal_batch = 4096;
+
+	uint64_t splitmix(uint64_t x)
+	{
+		x += 0x9e3779b97f4a7c15ull;
+		x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+		x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+		return x ^ (x >> 31);
+	}
+
+	// First count cards of a deck shuffled by the stream that starts at state.
+	template<class Variant>
+	void draw_cards(uint64_t state, char* cards, int count)
+	{
+		std::array<char, Variant::deck_size> deck;
+		for (int i = 0; i < Variant::deck_size; ++i) deck[i] = i;
+
+		for (int i = 0; i < count; ++i) {
+			state = splitmix(state);
+			int pick = i + static_cast<int>(state % (Variant::deck_size - i));
+			std::swap(deck[i], deck[pick]);
+			cards[i] = deck[i];
+		}
+	}
+
+	template<class Variant>
+	Card deck_card(char index)
+	{
+		SlimCard card = index_to_slim_card<Variant>(index);
+		return Card(static_cast<CardRank>(card.rank), static_cast<CardSuit>(card.suit));
+	}
+
+	inline int sign(int value)
+	{
+		return (value > 0) - (value < 0);
+	}
+
+	double seconds_since(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+
+	// DifferentialRunner
+
+	template<class Variant>
+	DifferentialRunner<Variant>::DifferentialRunner(ShowdownFactory factory, int threads, int max_repros)
+		: factory{ factory }, threads{ threads > 0 ? threads : std::max(1, static_cast<int>(std::thread::hardware_concurrency())) },
+		max_repros{ max_repros } {}
+
+	template<class Variant>
+	DifferentialReport DifferentialRunner<Variant>::exhaustive(int pairs, uint64_t seed)
+	{
+		std::vector<std::array<char, 4>> hands(pairs);
+		for (int i = 0; i < pairs; ++i) {
+			draw_cards<Variant>(splitmix(seed) ^ i, hands[i].data(), 4);
+		}
+
+		// one work item per pair and lowest board card
+		return run(static_cast<size_t>(pairs) * Variant::deck_size, [&](size_t item, std::vector<Deal>& deals) {
+			const std::array<char, 4>& hand = hands[item / Variant::deck_size];
+			uint64_t dead = card_mask(hand[0]) | card_mask(hand[1]) | card_mask(hand[2]) | card_mask(hand[3]);
+
+			std::array<char, 5> board;
+			board[0] = static_cast<char>(item % Variant::deck_size);
+			if (dead & card_mask(board[0])) return;
+
+			auto visit = [&](const std::array<char, 5>& cards) { deals.push_back(Deal{ hand, cards }); };
+			for_each_runout<Variant>(board, 1, board[0] + 1, dead, visit);
+		});
+	}
+
+	template<class Variant>
+	DifferentialReport DifferentialRunner<Variant>::random(uint64_t deals, uint64_t seed)
+	{
+		return run((deals + deal_batch - 1) / deal_batch, [&](size_t item, std::vector<Deal>& batch) {
+			uint64_t end = std::min<uint64_t>((item + 1) * deal_batch, deals);
+			for (uint64_t i = item * deal_batch; i < end; ++i) {
+				std::array<char, 9> cards;
+				draw_cards<Variant>(splitmix(seed) ^ i, cards.data(), 9);
+				batch.push_back(Deal{ { cards[0], cards[1], cards[2], cards[3] }, { cards[4], cards[5], cards[6], cards[7], cards[8] } });
+			}
+		});
+	}
+
+	template<class Variant>
+	template<class Producer>
+	DifferentialReport DifferentialRunner<Variant>::run(size_t items, Producer produce)
+	{
+		DifferentialReport report;
+		double engine_seconds = 0;
+		double reference_seconds = 0;
+		std::mutex mutex;
+		std::atomic<size_t> cursor{ 0 };
+
+		auto work = [&] {
+			Showdown engine = factory();
+			std::vector<Deal> deals;
+			std::vector<PokerHand> heroes;
+			std::vector<PokerHand> villains;
+			std::vector<Board> boards;
+			std::vector<int> engine_results;
+			std::vector<int> reference_results;
+
+			for (size_t item; (item = cursor++) < items;) {
+				deals.clear();
+				produce(item, deals);
+
+				for (size_t begin = 0; begin < deals.size(); begin += deal_batch) {
+					size_t end = std::min(begin + deal_batch, deals.size());
+
+					heroes.clear();
+					villains.clear();
+					boards.clear();
+					for (size_t i = begin; i < end; ++i) {
+						const Deal& deal = deals[i];
+						heroes.emplace_back(deck_card<Variant>(deal.hands[0]), deck_card<Variant>(deal.hands[1]));
+						villains.emplace_back(deck_card<Variant>(deal.hands[2]), deck_card<Variant>(deal.hands[3]));
+						boards.emplace_back();
+						for (char card : deal.board) boards.back().add_card(deck_card<Variant>(card));
+					}
+
+					auto start = std::chrono::steady_clock::now();
+					engine_results.clear();
+					for (size_t i = 0; i < boards.size(); ++i) {
+						engine_results.push_back(sign(engine(heroes[i], villains[i], boards[i])));
+					}
+					double engine_time = seconds_since(start);
+
+					start = std::chrono::steady_clock::now();
+					reference_results.clear();
+					for (size_t i = begin; i < end; ++i) {
+						const Deal& deal = deals[i];
+						std::array<SlimCard, 7> hero;
+						std::array<SlimCard, 7> vill;
+						for (int j = 0; j < 5; ++j) hero[j] = vill[j] = index_to_slim_card<Variant>(deal.board[j]);
+						hero[5] = index_to_slim_card<Variant>(deal.hands[0]);
+						hero[6] = index_to_slim_card<Variant>(deal.hands[1]);
+						vill[5] = index_to_slim_card<Variant>(deal.hands[2]);
+						vill[6] = index_to_slim_card<Variant>(deal.hands[3]);
+						reference_results.push_back(sign(ReferenceEvaluator<Variant>::evaluate(hero) - ReferenceEvaluator<Variant>::evaluate(vill)));
+					}
+					double reference_time = seconds_since(start);
+
+					std::lock_guard<std::mutex> lock(mutex);
+					report.comparisons += boards.size();
+					engine_seconds += engine_time;
+					reference_seconds += reference_time;
+					for (size_t i = 0; i < boards.size(); ++i) {
+						if (engine_results[i] == reference_results[i]) continue;
+
+						++report.mismatches;
+						if (static_cast<int>(report.repros.size()) < max_repros) {
+							report.repros.push_back(heroes[i].repr() + " " + villains[i].repr() + " " + boards[i].repr()
+								+ ": engine " + std::to_string(engine_results[i]) + ", reference " + std::to_string(reference_results[i]));
+						}
+					}
+				}
+			}
+		};
+
+		std::vector<std::thread> workers;
+		for (int i = 1; i < threads; ++i) workers.emplace_back(work);
+		work();
+		for (auto& worker : workers) worker.join();
+
+		if (engine_seconds > 0) report.engine_rate = report.comparisons / engine_seconds;
+		if (reference_seconds > 0) report.reference_rate = report.comparisons / reference_seconds;
+		return report;
+	}
+
+	template class DifferentialRunner<Holdem>;
+	template class DifferentialRunner<ShortDeck>;
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "reference_evaluator.h"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Poker {
+	// Sign of hero's strength minus villain's on a complete five card board.
+	using Showdown = std::function<int(const PokerHand& hero, const PokerHand& vill, const Board& board)>;
+	// Engines may keep per-query state, so each worker thread builds its own instance.
+	using ShowdownFactory = std::function<Showdown()>;
+
+	struct DifferentialReport {
+		uint64_t comparisons = 0;
+		uint64_t mismatches = 0;
+		// "hero vill board: engine x, reference y" for the first mismatches found
+		std::vector<std::string> repros;
+		// showdowns per second of one thread
+		double engine_rate = 0;
+		double reference_rate = 0;
+	};
+
+	// Compares an engine against ReferenceEvaluator on many threads. Deals are derived from the
+	// seed alone, so a run reproduces regardless of the thread count.
+	template<class Variant = Holdem>
+	class DifferentialRunner {
+	public:
+		DifferentialRunner(ShowdownFactory factory, int threads = 0, int max_repros = 20);
+
+		// Every board for each of pairs sampled hero and villain hands.
+		DifferentialReport exhaustive(int pairs, uint64_t seed = 0);
+		// Uniformly random hands and boards.
+		DifferentialReport random(uint64_t deals, uint64_t seed = 0);
+
+	private:
+		struct Deal {
+			std::array<char, 4> hands;
+			std::array<char, 5> board;
+		};
+
+		template<class Producer>
+		DifferentialReport run(size_t items, Producer produce);
+
+		ShowdownFactory factory;
+		int threads;
+		int max_repros;
+	};
+}
\ No newline at end of file
@@ -1,8 +1,13 @@
 #include "equity.h"
 
 #include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <numeric>
 #include <memory>
+#include <stdexcept>
+#include <functional>
+#include <thread>
 
 namespace Poker {
 	// utility
@@ -19,20 +24,7 @@ namespace Poker {
 
 	bool is_taken_board(const Card& card, const Board& board)
 	{
-		for (const Card& board_card : board) {
-			if (strict_equal(card, board_card)) return true;
-		}
-
-		return false;
-	}
-
-	bool is_taken_board(const SlimCard& card, const SlimBoard& board)
-	{
-		for (char i = 0; i < board.size(); ++i) {
-			if (strict_equal(card, board[i])) return true;
-		}
-
-		return false;
+		return board.mask() & card_mask(card_bit(card));
 	}
 
 	bool is_taken(const Card& card, const PokerHand& hero, const PokerHand& vill, const Board& board)
@@ -42,30 +34,11 @@ namespace Poker {
 			is_taken_board(card, board);
 	}
 
-	bool is_taken(const SlimCard& card, const SlimHand& hero, const SlimHand& vill, const SlimBoard& board)
-	{
-		return	strict_equal(card, hero.primary) || strict_equal(card, hero.secondary) ||
-			strict_equal(card, vill.primary) || strict_equal(card, vill.secondary) ||
-			is_taken_board(card, board);
-	}
-
-
-	int card_to_index(const Card& card) {
-		return (static_cast<int>(card.get_rank()) - 2) * 4 + static_cast<int>(card.get_suit());
-	}
 
 	Card index_to_card(int index) {
 		return Card(static_cast<CardRank>((index / 4) + 2), static_cast<CardSuit>(index % 4));
 	}
 
-	char slim_card_to_index(const SlimCard& card) {
-		return (card.rank - 2) * 4 + card.suit;
-	}
-
-	SlimCard index_to_slim_card(char index) {
-		return SlimCard{ (index / 4) + 2 , index % 4 };
-	}
-
 	bool is_valid(const Board& board, const std::array<int, 52>& hand_ranks)
 	{
 		return !(hand_ranks[card_to_index(board[0])]
@@ -75,21 +48,30 @@ namespace Poker {
 			+ hand_ranks[card_to_index(board[4])]);
 	}
 
-	bool is_valid(const std::array<SlimCard, 5> board, const std::array<char, 52>& hand_ranks)
+	// A hole card outweighs a full board, so the sum over a runout equals the number of known
+	// board cards only if the runout avoids every hole card and contains every board card.
+	const char hole_weight = 6;
+
+	template<class Variant>
+	bool is_valid(const std::array<SlimCard, 5> board, const std::array<char, Variant::deck_size>& hand_ranks, char known_cards)
 	{
-		return !(hand_ranks[slim_card_to_index(board[0])]
-			+ hand_ranks[slim_card_to_index(board[1])]
-			+ hand_ranks[slim_card_to_index(board[2])]
-			+ hand_ranks[slim_card_to_index(board[3])]
-			+ hand_ranks[slim_card_to_index(board[4])]);
+		return hand_ranks[slim_card_to_index<Variant>(board[0])]
+			+ hand_ranks[slim_card_to_index<Variant>(board[1])]
+			+ hand_ranks[slim_card_to_index<Variant>(board[2])]
+			+ hand_ranks[slim_card_to_index<Variant>(board[3])]
+			+ hand_ranks[slim_card_to_index<Variant>(board[4])] == known_cards;
 	}
 
-	void set_hand_ranks(const SlimHand& hero, const SlimHand& vill, std::array<char, 52>& ranks) {
+	template<class Variant>
+	void set_hand_ranks(const SlimHand& hero, const SlimHand& vill, const Board& board, std::array<char, Variant::deck_size>& ranks) {
 		ranks = { 0 };
-		++ranks[slim_card_to_index(hero.primary)];
-		++ranks[slim_card_to_index(hero.secondary)];
-		++ranks[slim_card_to_index(vill.primary)];
-		++ranks[slim_card_to_index(vill.secondary)];
+		ranks[slim_card_to_index<Variant>(hero.primary)] += hole_weight;
+		ranks[slim_card_to_index<Variant>(hero.secondary)] += hole_weight;
+		ranks[slim_card_to_index<Variant>(vill.primary)] += hole_weight;
+		ranks[slim_card_to_index<Variant>(vill.secondary)] += hole_weight;
+		for (const Card& card : board) {
+			++ranks[card_to_index<Variant>(card)];
+		}
 	}
 
 
@@ -106,166 +88,208 @@ namespace Poker {
 
 	// CachedEquitySolver
 
-	CachedEquitySolver::CachedEquitySolver(bool test) : evaluator{ CachedEvaluator(hero_cache, vill_cache, board_cache) }, all_boards{ test ? 0 : 2'598'960 }, all_hands{ 1326 }
+	template<class Variant>
+	BasicCachedEquitySolver<Variant>::BasicCachedEquitySolver(bool test, TableOptions options, EvaluatorEngine engine)
+		: engine{ engine }, evaluator{ BasicCachedEvaluator<Variant>(hero_cache, vill_cache, board_cache, rank_classes) },
+		lookup_evaluator{ LookupEvaluator(hero_cache, vill_cache, board_cache, lookup) },
+		all_boards{ std::make_shared<NumaTable<BoardCache>>(test ? 0 : Variant::board_count, options) },
+		all_rank_classes{ std::make_shared<std::vector<RankClass>>() }, symmetry_cache{ std::make_shared<SymmetryCache>() },
+		all_hands{ Variant::hand_count }
 	{
 		if (!test) {
-			cache_boards_r(0);
-		}
-
-		cache_hands();
-	}
-
-
-	// CachedEquitySolver, board_cache
-
-	char is_straight(const std::array<SlimCard, 5>& board, char primary, char secondary)
-	{
-		std::array<char, 7> ranks = {
-			primary, secondary,
-			board[0].rank, board[1].rank, board[2].rank, board[3].rank, board[4].rank };
-		std::sort(ranks.rbegin(), ranks.rend());
-
-		int counter = 0;
-		char curr_rank;
-		char top_rank = 1;
-
-		char i = 0;
-		for (; i < 3; ++i) {
-			curr_rank = ranks[i];
-
-			if (curr_rank == ranks[i + 1]) {
-				continue;
+			std::vector<uint16_t> class_ids;
+			cache_rank_classes(class_ids);
+			rank_classes = all_rank_classes->data();
+
+			// every slice is unranked independently, so the table fills in parallel in its usual order
+			int threads = std::max(1u, std::thread::hardware_concurrency());
+			std::vector<std::thread> workers;
+			for (int i = 0; i < threads; ++i) {
+				int begin = static_cast<int>(static_cast<int64_t>(Variant::board_count) * i / threads);
+				int end = static_cast<int>(static_cast<int64_t>(Variant::board_count) * (i + 1) / threads);
+				workers.emplace_back(&BasicCachedEquitySolver::cache_boards, this, begin, end, std::cref(class_ids));
 			}
+			for (auto& worker : workers) worker.join();
 
-			if (ranks[i + 1] == curr_rank - 1) {
-				++counter;
-				if (counter == 1) top_rank = curr_rank;
-			}
-			else {
-				counter = 0;
-			}
+			all_boards->replicate();
 		}
 
-		if (counter == 0 &&
-			(ranks.back() != 2 || ranks.front() != 14))
-		{
-			return 1;
-		}
-
-		for (; i < 6; ++i) {
-			curr_rank = ranks[i];
-
-			if (curr_rank == ranks[i + 1]) {
-				continue;
-			}
+		cache_hands();
 
-			if (ranks[i + 1] == curr_rank - 1) {
-				++counter;
-				if (counter == 4) return top_rank;
-			}
-			else {
-				return 1;
+		if (engine == EvaluatorEngine::LOOKUP) {
+			if (Variant::deck_size != 52) {
+				throw std::invalid_argument("The lookup engine only supports the standard deck");
 			}
+			lookup_table = LookupTable::load_or_generate();
+			lookup = lookup_table.get();
 		}
+	}
 
-		if (counter == 3 &&
-			ranks.back() == 2 &&
-			ranks.front() == 14)
-		{
-			return 5;
-		}
+	template<class Variant>
+	BasicCachedEquitySolver<Variant>::BasicCachedEquitySolver(const BasicCachedEquitySolver& other)
+		: engine{ other.engine }, evaluator{ BasicCachedEvaluator<Variant>(hero_cache, vill_cache, board_cache, rank_classes) },
+		lookup_evaluator{ LookupEvaluator(hero_cache, vill_cache, board_cache, lookup) }, lookup_table{ other.lookup_table },
+		all_boards{ other.all_boards }, all_rank_classes{ other.all_rank_classes }, symmetry_cache{ other.symmetry_cache },
+		all_hands{ other.all_hands },
+		rank_classes{ other.rank_classes }, lookup{ other.lookup } {}
 
-		return 1;
-	}
 
-	void cache_board_straights(BoardCache& cache)
-	{
-		for (char c_1 = 14; c_1 >= 2; --c_1) {
-			for (char c_2 = c_1; c_2 >= 2; --c_2) {
-				cache.straights[c_1 - 2][c_2 - 2] = is_straight(cache.board, c_1, c_2);
-			}
-		}
-	}
+	// CachedEquitySolver, board_cache
 
-	void cache_board_ranks(BoardCache& cache, std::array<char, 15>& temp_ranks)
+	void cache_board_ranks(RankClass& cache, const std::array<char, 5>& board)
 	{
-		temp_ranks = { 0 };
-		for (auto& card : cache.board) {
-			++temp_ranks[static_cast<int>(card.rank)];
+		std::array<char, 15> temp_ranks = { 0 };
+		for (char rank : board) {
+			++temp_ranks[rank];
 		}
 
-		cache.ranks.reserve(5);
+		cache.rank_count = 0;
+		cache.rank_mask = 0;
 		for (char i = 14; i >= 2; --i) {
 			if (temp_ranks[i] > 0) {
-				cache.ranks.emplace_back(i, temp_ranks[i]);
+				cache.ranks[cache.rank_count++] = { i, temp_ranks[i] };
+				cache.rank_mask |= 1 << i;
 			}
 		}
-		cache.ranks.shrink_to_fit();
 	}
 
 	void cache_board_suits(BoardCache& cache)
 	{
+		std::array<char, 4> suits = { 0 };
 		for (auto& card : cache.board) {
-			++cache.suits[static_cast<int>(card.suit)];
+			++suits[static_cast<int>(card.suit)];
 		}
 
 		for (char i = 0; i < 4; ++i) {
-			if (cache.suits[i] >= 3) {
+			if (suits[i] >= 3) {
 				cache.max_suit = i;
-				cache.suit_count = cache.suits[i];
+				cache.suit_count = suits[i];
 				break;
 			}
 		}
 	}
 
-	void fill_board_cache(BoardCache& cache, std::array<char, 15>& temp_ranks)
+	// Base-13 key of a descending rank multiset.
+	template<class Variant>
+	int rank_key(const std::array<char, 5>& ranks)
 	{
-		cache_board_straights(cache);
-		cache_board_ranks(cache, temp_ranks);
-		cache_board_suits(cache);
-		std::sort(cache.board.rbegin(), cache.board.rend());
+		int key = 0;
+		for (char rank : ranks) {
+			key = key * 13 + rank - Variant::min_rank;
+		}
+		return key;
 	}
 
-	void CachedEquitySolver::cache_boards_r(int start_index)
+	template<class Variant>
+	void BasicCachedEquitySolver<Variant>::cache_rank_classes(std::vector<uint16_t>& class_ids)
 	{
-		if (board.size() == 5) {
-			all_boards[index].board = { board[0], board[1], board[2], board[3], board[4] };
-			fill_board_cache(all_boards[index], temp_ranks);
-			++index;
+		class_ids.assign(13 * 13 * 13 * 13 * 13, 0);
+
+		std::array<char, 5> ranks;
+		for (ranks[0] = 14; ranks[0] >= Variant::min_rank; --ranks[0])
+		for (ranks[1] = ranks[0]; ranks[1] >= Variant::min_rank; --ranks[1])
+		for (ranks[2] = ranks[1]; ranks[2] >= Variant::min_rank; --ranks[2])
+		for (ranks[3] = ranks[2]; ranks[3] >= Variant::min_rank; --ranks[3])
+		for (ranks[4] = ranks[3]; ranks[4] >= Variant::min_rank; --ranks[4]) {
+			if (ranks[0] == ranks[4]) continue;
+
+			RankClass cache;
+			cache_board_ranks(cache, ranks);
+
+			class_ids[rank_key<Variant>(ranks)] = static_cast<uint16_t>(all_rank_classes->size());
+			all_rank_classes->push_back(cache);
 		}
-		else {
-			SlimCard card;
-			for (char i = start_index; i < 52; i++) {
-				card = { (i / 4) + 2, i % 4 };
-				if (is_taken_board(card, board)) {
-					continue;
-				}
+	}
 
-				board.add_card(card);
-				cache_boards_r(i + 1);
-				board.pop_card();
-			}
+	template<class Variant>
+	void fill_board_cache(BoardCache& cache, const std::vector<uint16_t>& class_ids)
+	{
+		std::sort(cache.board.rbegin(), cache.board.rend());
+		cache_board_suits(cache);
+
+		std::array<char, 5> ranks;
+		for (int i = 0; i < 5; ++i) {
+			ranks[i] = cache.board[i].rank;
 		}
+		cache.rank_class = class_ids[rank_key<Variant>(ranks)];
 	}
 
+	int binomial(int n, int k)
+	{
+		if (k < 0 || k > n) return 0;
 
-	// CachedEquitySolver, hand_cache
+		int64_t result = 1;
+		for (int i = 1; i <= k; ++i) {
+			result = result * (n - k + i) / i;
+		}
+		return static_cast<int>(result);
+	}
 
-	int arith_series(int n) {
-		return n * (n + 1) / 2;
+	// Cards of the index-th 5-card combination of a deck_size deck in lexicographic order.
+	template<class Variant>
+	std::array<char, 5> unrank_board(int index)
+	{
+		std::array<char, 5> cards;
+		char card = 0;
+		for (int i = 0; i < 5; ++i) {
+			for (int count; (count = binomial(Variant::deck_size - card - 1, 4 - i)) <= index; ++card) {
+				index -= count;
+			}
+			cards[i] = card++;
+		}
+		return cards;
 	}
 
-	int hand_to_index(const PokerHand& hand)
+	// Inverse of unrank_board for ascending cards.
+	template<class Variant>
+	int rank_board(const std::array<char, 5>& cards)
 	{
-		return arith_series(card_to_index(hand.get_primary()) - 1) + card_to_index(hand.get_secondary());
+		int index = 0;
+		char card = 0;
+		for (int i = 0; i < 5; ++i) {
+			for (; card < cards[i]; ++card) {
+				index += binomial(Variant::deck_size - card - 1, 4 - i);
+			}
+			++card;
+		}
+		return index;
+	}
 
+	template<class Variant>
+	void next_board(std::array<char, 5>& cards)
+	{
+		int i = 4;
+		while (i >= 0 && cards[i] == Variant::deck_size - 5 + i) --i;
+		if (i < 0) return;
+
+		++cards[i];
+		for (int j = i + 1; j < 5; ++j) {
+			cards[j] = cards[j - 1] + 1;
+		}
 	}
-	int hand_to_index(const SlimHand& hand)
+
+	template<class Variant>
+	void BasicCachedEquitySolver<Variant>::cache_boards(int begin, int end, const std::vector<uint16_t>& class_ids)
 	{
-		return arith_series(slim_card_to_index(hand.primary) - 1) + slim_card_to_index(hand.secondary);
+		if (begin >= end) return;
+
+		std::array<char, 5> cards = unrank_board<Variant>(begin);
+		Table<BoardCache>& boards = all_boards->primary();
+
+		for (int index = begin; index < end; ++index) {
+			BoardCache& cache = boards[index];
+			for (int i = 0; i < 5; ++i) {
+				cache.board[i] = index_to_slim_card<Variant>(cards[i]);
+			}
+			fill_board_cache<Variant>(cache, class_ids);
+
+			next_board<Variant>(cards);
+		}
 	}
 
 
+	// CachedEquitySolver, hand_cache
+
 	void cache_hand_ranks(HandCache& cache)
 	{
 		++cache.ranks[cache.hand.primary.rank];
@@ -284,14 +308,15 @@ namespace Poker {
 		cache_hand_suits(cache);
 	}
 
-	void CachedEquitySolver::cache_hands()
+	template<class Variant>
+	void BasicCachedEquitySolver<Variant>::cache_hands()
 	{
 		SlimHand hand;
 		int index;
-		for (char c_1 = 1; c_1 < 52; ++c_1) {
+		for (char c_1 = 1; c_1 < Variant::deck_size; ++c_1) {
 			for (char c_2 = 0; c_2 < c_1; ++c_2) {
-				hand = SlimHand{ index_to_slim_card(c_1), index_to_slim_card(c_2) };
-				index = hand_to_index(hand);
+				hand = SlimHand{ index_to_slim_card<Variant>(c_1), index_to_slim_card<Variant>(c_2) };
+				index = hand_to_index<Variant>(hand);
 				all_hands[index].hand = hand;
 				fill_hand_cache(all_hands[index]);
 			}
@@ -299,6 +324,94 @@ namespace Poker {
 	}
 
 
+	// CachedEquitySolver, suit symmetry
+
+	// Suits form a class when their cards play identical roles, i.e. the same ranks in hero's hand,
+	// villain's hand and the known board. classes[suit] is the lowest suit of its class.
+	std::array<int, 4> suit_classes(const SlimHand& hero, const SlimHand& vill, const Board& board)
+	{
+		std::array<uint64_t, 4> roles = { 0 };
+		roles[hero.primary.suit] |= uint64_t{ 1 } << hero.primary.rank;
+		roles[hero.secondary.suit] |= uint64_t{ 1 } << hero.secondary.rank;
+		roles[vill.primary.suit] |= uint64_t{ 1 } << (vill.primary.rank + 16);
+		roles[vill.secondary.suit] |= uint64_t{ 1 } << (vill.secondary.rank + 16);
+		for (const Card& card : board) {
+			roles[static_cast<int>(card.get_suit())] |= uint64_t{ 1 } << (static_cast<int>(card.get_rank()) + 32);
+		}
+
+		std::array<int, 4> classes;
+		for (int suit = 0; suit < 4; ++suit) {
+			classes[suit] = suit;
+			for (int other = 0; other < suit; ++other) {
+				if (roles[other] == roles[suit]) {
+					classes[suit] = other;
+					break;
+				}
+			}
+		}
+		return classes;
+	}
+
+	// A board is canonical when the rank masks of its suits don't increase within any class; its
+	// orbit holds one board per distinct arrangement of those masks.
+	SymmetricBoards find_symmetric_boards(const Table<BoardCache>& boards, const std::array<int, 4>& classes)
+	{
+		const int factorials[] = { 1, 1, 2, 6, 24 };
+
+		SymmetricBoards symmetric;
+		for (size_t i = 0; i < boards.size(); ++i) {
+			std::array<int, 4> masks = { 0 };
+			for (const SlimCard& card : boards[i].board) masks[card.suit] |= 1 << card.rank;
+
+			bool canonical = true;
+			int weight = 1;
+			for (int suit = 0; suit < 4 && canonical; ++suit) {
+				if (classes[suit] != suit) continue;
+
+				int size = 1;
+				int run = 1;
+				int repeats = 1;
+				int previous = suit;
+				for (int other = suit + 1; other < 4; ++other) {
+					if (classes[other] != suit) continue;
+
+					if (masks[other] > masks[previous]) {
+						canonical = false;
+						break;
+					}
+					run = masks[other] == masks[previous] ? run + 1 : 1;
+					repeats *= run;
+					++size;
+					previous = other;
+				}
+				weight *= factorials[size] / repeats;
+			}
+
+			if (!canonical) continue;
+			symmetric.indices.push_back(static_cast<uint32_t>(i));
+			symmetric.weights.push_back(static_cast<uint8_t>(weight));
+		}
+		return symmetric;
+	}
+
+	template<class Variant>
+	const SymmetricBoards* BasicCachedEquitySolver<Variant>::symmetric_boards(const Board& board)
+	{
+		std::array<int, 4> classes = suit_classes(hero_cache->hand, vill_cache->hand, board);
+		if (classes == std::array<int, 4>{ 0, 1, 2, 3 }) return nullptr;
+
+		// suit 0 always leads its class, so the other three labels identify the partition
+		int key = classes[1] + 4 * classes[2] + 16 * classes[3];
+
+		std::lock_guard<std::mutex> lock(symmetry_cache->mutex);
+		std::shared_ptr<const SymmetricBoards>& symmetric = symmetry_cache->partitions[key];
+		if (!symmetric) {
+			symmetric = std::make_shared<const SymmetricBoards>(find_symmetric_boards(all_boards->local(), classes));
+		}
+		return symmetric.get();
+	}
+
+
 	// CachedEquitySolver, enumerate
 
 	Winner to_winner(int result) {
@@ -307,17 +420,72 @@ namespace Poker {
 		else return Winner::SPLIT;
 	}
 
-	double CachedEquitySolver::enumerate(const PokerHand& hero, const PokerHand& vill, const Board& board)
+	template<class Variant>
+	void BasicCachedEquitySolver<Variant>::set_hands(const PokerHand& hero, const PokerHand& vill, const Board& board)
+	{
+		hero_cache = &all_hands[hand_to_index<Variant>(hero)];
+		vill_cache = &all_hands[hand_to_index<Variant>(vill)];
+		set_hand_ranks<Variant>(hero_cache->hand, vill_cache->hand, board, hand_ranks);
+		known_cards = board.size();
+	}
+
+	template<class Variant>
+	double BasicCachedEquitySolver<Variant>::enumerate(const PokerHand& hero, const PokerHand& vill, const Board& board)
 	{
-		Board runtime_board;
 		reset();
-		hero_cache = &all_hands[hand_to_index(hero)];
-		vill_cache = &all_hands[hand_to_index(vill)];
-		set_hand_ranks(hero_cache->hand, vill_cache->hand, hand_ranks);
+		set_hands(hero, vill, board);
+
+		if (const SymmetricBoards* symmetric = symmetric_boards(board)) {
+			if (engine == EvaluatorEngine::LOOKUP) return enumerate_boards(lookup_evaluator, *symmetric);
+			return enumerate_boards(evaluator, *symmetric);
+		}
+
+		if (engine == EvaluatorEngine::LOOKUP) return enumerate_boards(lookup_evaluator);
+		return enumerate_boards(evaluator);
+	}
+
+	template<class Variant>
+	ShardCounts BasicCachedEquitySolver<Variant>::enumerate(const PokerHand& hero, const PokerHand& vill, const Board& board, size_t begin, size_t end)
+	{
+		set_hands(hero, vill, board);
+
+		if (engine == EvaluatorEngine::LOOKUP) return count_boards(lookup_evaluator, begin, end);
+		return count_boards(evaluator, begin, end);
+	}
+
+	template<class Variant>
+	AnytimeEquity BasicCachedEquitySolver<Variant>::enumerate(const PokerHand& hero, const PokerHand& vill, const Board& board, std::chrono::nanoseconds budget)
+	{
+		set_hands(hero, vill, board);
+		auto deadline = std::chrono::steady_clock::now() + budget;
+
+		if (engine == EvaluatorEngine::LOOKUP) return sample_boards(lookup_evaluator, deadline);
+		return sample_boards(evaluator, deadline);
+	}
+
+	template<class Variant>
+	int BasicCachedEquitySolver<Variant>::showdown(const PokerHand& hero, const PokerHand& vill, const Board& board)
+	{
+		if (board.size() != 5) throw std::invalid_argument("Showdown needs a complete board: " + board.repr());
 
-		BoardCache* end = &all_boards.back() + 1;
-		for (board_cache = &all_boards[0]; board_cache != end; ++board_cache) {
-			if (!is_valid(board_cache->board, hand_ranks)) continue;
+		set_hands(hero, vill, board);
+		std::array<char, 5> cards;
+		for (int i = 0; i < 5; ++i) cards[i] = card_to_index<Variant>(board[i]);
+		std::sort(cards.begin(), cards.end());
+		board_cache = all_boards->local().data() + rank_board<Variant>(cards);
+
+		int result = engine == EvaluatorEngine::LOOKUP ? lookup_evaluator.evaluate() : evaluator.evaluate();
+		return (result > 0) - (result < 0);
+	}
+
+	template<class Variant>
+	template<class Evaluator>
+	double BasicCachedEquitySolver<Variant>::enumerate_boards(Evaluator& evaluator)
+	{
+		const Table<BoardCache>& boards = all_boards->local();
+		const BoardCache* end = boards.data() + boards.size();
+		for (board_cache = boards.data(); board_cache != end; ++board_cache) {
+			if (!is_valid<Variant>(board_cache->board, hand_ranks, known_cards)) continue;
 
 			Winner cached = to_winner(evaluator.evaluate());
 			add_result(cached);
@@ -325,4 +493,356 @@ namespace Poker {
 
 		return calc_equity();
 	}
-}
+
+	// Boards that are suit relabelings of each other have the same outcome whenever the relabeling
+	// maps both hands and the known board onto themselves, so only one board per orbit is evaluated.
+	template<class Variant>
+	template<class Evaluator>
+	double BasicCachedEquitySolver<Variant>::enumerate_boards(Evaluator& evaluator, const SymmetricBoards& symmetric)
+	{
+		const BoardCache* boards = all_boards->local().data();
+
+		// scores are counted in half points: 2 for a win, 1 for a tie
+		uint64_t points = 0;
+		uint64_t total = 0;
+		for (size_t i = 0; i < symmetric.indices.size(); ++i) {
+			board_cache = boards + symmetric.indices[i];
+			if (!is_valid<Variant>(board_cache->board, hand_ranks, known_cards)) continue;
+
+			int result = evaluator.evaluate();
+			points += symmetric.weights[i] * (result > 0 ? 2 : result == 0 ? 1 : 0);
+			total += symmetric.weights[i];
+		}
+
+		return points / 2.0 / total;
+	}
+
+	template<class Variant>
+	template<class Evaluator>
+	ShardCounts BasicCachedEquitySolver<Variant>::count_boards(Evaluator& evaluator, size_t begin, size_t end)
+	{
+		const Table<BoardCache>& boards = all_boards->local();
+		const BoardCache* stop = boards.data() + std::min(end, boards.size());
+
+		ShardCounts counts;
+		for (board_cache = boards.data() + std::min(begin, boards.size()); board_cache < stop; ++board_cache) {
+			if (!is_valid<Variant>(board_cache->board, hand_ranks, known_cards)) continue;
+
+			int result = evaluator.evaluate();
+			if (result > 0) ++counts.wins;
+			else if (result < 0) ++counts.losses;
+			else ++counts.ties;
+		}
+
+		return counts;
+	}
+
+	// Steps through the table in blocks of four consecutive boards (about a cache line), by a
+	// block stride near count / golden ratio, which spreads any prefix of the walk evenly over
+	// the table. Larger blocks finish sooner but their boards are too alike, which costs more
+	// accuracy early on than it saves. The start is uniform, so every block is equally likely to be
+	// in a prefix of k blocks (k / count); scaling the prefix sum by count / k over the known
+	// number of valid boards is an unbiased estimate. Postflop almost every table entry misses the
+	// known cards (a turn leaves 44 of 2.6M), so the walk then runs over the list of valid boards.
+	template<class Variant>
+	template<class Evaluator>
+	AnytimeEquity BasicCachedEquitySolver<Variant>::sample_boards(Evaluator& evaluator, std::chrono::steady_clock::time_point deadline)
+	{
+		const uint64_t block_size = 4;
+		const uint64_t check_interval = 256;
+
+		const Table<BoardCache>& boards = all_boards->local();
+		const double valid = binomial(Variant::deck_size - 4 - known_cards, 5 - known_cards);
+
+		const uint32_t* indices = nullptr;
+		if (known_cards) {
+			std::array<char, 5> runout;
+			uint64_t dead = 0;
+			int size = 0;
+			for (int card = 0; card < Variant::deck_size; ++card) {
+				if (!hand_ranks[card]) continue;
+				dead |= card_mask(card);
+				if (hand_ranks[card] == 1) runout[size++] = card;
+			}
+
+			runout_boards.clear();
+			auto visit = [this](std::array<char, 5>& cards) {
+				std::array<char, 5> sorted = cards;
+				std::sort(sorted.begin(), sorted.end());
+				runout_boards.push_back(static_cast<uint32_t>(rank_board<Variant>(sorted)));
+			};
+			for_each_runout<Variant>(runout, size, 0, dead, visit);
+			std::sort(runout_boards.begin(), runout_boards.end());
+			indices = runout_boards.data();
+		}
+
+		const uint64_t size = indices ? runout_boards.size() : boards.size();
+		const uint64_t block_count = (size + block_size - 1) / block_size;
+
+		AnytimeEquity result;
+		if (!size || !valid) return result;
+
+		uint64_t stride = static_cast<uint64_t>(block_count * 0.6180339887498949);
+		while (std::gcd(stride, block_count) != 1) ++stride;
+		uint64_t block = std::uniform_int_distribution<uint64_t>(0, block_count - 1)(rng);
+
+		// scores are counted in half points: 2 for a win, 1 for a tie
+		uint64_t points = 0;
+		uint64_t squares = 0;
+		uint64_t blocks = 0;
+		uint64_t visited = 0;
+
+		while (blocks < block_count) {
+			uint64_t stop = std::min(blocks + check_interval, block_count);
+			for (; blocks < stop; ++blocks) {
+				uint64_t begin = block * block_size;
+				uint64_t end = std::min(begin + block_size, size);
+				block += stride;
+				if (block >= block_count) block -= block_count;
+
+				uint64_t block_points = 0;
+				for (uint64_t slot = begin; slot < end; ++slot) {
+					board_cache = boards.data() + (indices ? indices[slot] : slot);
+					if (!is_valid<Variant>(board_cache->board, hand_ranks, known_cards)) continue;
+
+					int outcome = evaluator.evaluate();
+					block_points += outcome > 0 ? 2 : outcome == 0 ? 1 : 0;
+					++visited;
+				}
+				points += block_points;
+				squares += block_points * block_points;
+			}
+
+			if (blocks < block_count && std::chrono::steady_clock::now() >= deadline) break;
+		}
+
+		result.coverage = visited / valid;
+		result.complete = blocks == block_count;
+		if (result.complete) {
+			result.equity = points / 2.0 / valid;
+			return result;
+		}
+
+		// boards in a block are correlated, so the block totals are the samples; the bound treats
+		// the prefix as a simple random sample of blocks, which the even spread only improves on
+		double fraction = static_cast<double>(blocks) / block_count;
+		double mean = static_cast<double>(points) / blocks;
+		double variance = (static_cast<double>(squares) / blocks - mean * mean) * blocks / std::max<uint64_t>(blocks - 1, 1);
+		double mean_error = std::sqrt(std::max(variance, 0.0) * (1 - fraction) / blocks);
+
+		result.equity = mean * block_count / 2 / valid;
+		result.error = 1.96 * mean_error * block_count / 2 / valid;
+		return result;
+	}
+
+
+	// CachedEquitySolver, range enumerate
+
+	struct RangeEntry {
+		int strength;
+		int combo;
+		double weight;
+		char primary;
+		char secondary;
+	};
+
+	inline bool operator<(const RangeEntry& hero, const RangeEntry& vill) { return hero.strength < vill.strength; }
+
+	template<class Variant>
+	RangeEquity BasicCachedEquitySolver<Variant>::enumerate(const PokerRange& hero, const PokerRange& vill, const Board& board)
+	{
+		std::array<char, 5> runout;
+		int board_size = 0;
+		uint64_t dead = 0;
+		for (const Card& card : board) {
+			runout[board_size] = card_to_index<Variant>(card);
+			dead |= card_mask(runout[board_size++]);
+		}
+
+		// villain weights are merged per combo, so the sweep only sees each combo once
+		std::vector<int> hero_indices(hero.size());
+		std::vector<double> vill_weights(Variant::hand_count, 0);
+		std::vector<char> is_used(Variant::hand_count, 0);
+		std::vector<int> used;
+		for (int i = 0; i < hero.size(); ++i) {
+			hero_indices[i] = hand_to_index<Variant>(hero[i]);
+			if (!is_used[hero_indices[i]]++) used.push_back(hero_indices[i]);
+		}
+		for (int i = 0; i < vill.size(); ++i) {
+			int index = hand_to_index<Variant>(vill[i]);
+			vill_weights[index] += vill.weight(i);
+			if (!is_used[index]++) used.push_back(index);
+		}
+
+		std::vector<int> vill_indices;
+		for (int index : used) {
+			if (vill_weights[index] > 0) vill_indices.push_back(index);
+		}
+
+		std::vector<int> strengths(Variant::hand_count, -1);
+		std::vector<double> wins(hero.size(), 0);
+		std::vector<double> totals(hero.size(), 0);
+		std::vector<RangeEntry> hero_entries;
+		std::vector<RangeEntry> vill_entries;
+		hero_entries.reserve(hero.size());
+		vill_entries.reserve(vill_indices.size());
+
+		auto visit = [&](const std::array<char, 5>& cards) {
+			SuitMasks board_masks = { 0 };
+			uint64_t board_mask = 0;
+			for (char index : cards) {
+				add_card(board_masks, index_to_slim_card<Variant>(index));
+				board_mask |= card_mask(index);
+			}
+
+			// score every combo once per runout
+			for (int index : used) {
+				const SlimHand& hand = all_hands[index].hand;
+				char primary = slim_card_to_index<Variant>(hand.primary);
+				char secondary = slim_card_to_index<Variant>(hand.secondary);
+				if (board_mask & (card_mask(primary) | card_mask(secondary))) {
+					strengths[index] = -1;
+					continue;
+				}
+
+				SuitMasks masks = board_masks;
+				add_card(masks, hand.primary);
+				add_card(masks, hand.secondary);
+				strengths[index] = BasicStrengthEvaluator<Variant>::evaluate(masks);
+			}
+
+			hero_entries.clear();
+			for (int i = 0; i < hero.size(); ++i) {
+				int index = hero_indices[i];
+				if (strengths[index] < 0) continue;
+
+				const SlimHand& hand = all_hands[index].hand;
+				hero_entries.push_back({ strengths[index], i, hero.weight(i), slim_card_to_index<Variant>(hand.primary), slim_card_to_index<Variant>(hand.secondary) });
+			}
+
+			std::array<double, Variant::deck_size> all_card = { 0 };
+			double all_total = 0;
+			vill_entries.clear();
+			for (int index : vill_indices) {
+				if (strengths[index] < 0) continue;
+
+				const SlimHand& hand = all_hands[index].hand;
+				RangeEntry entry = { strengths[index], index, vill_weights[index], slim_card_to_index<Variant>(hand.primary), slim_card_to_index<Variant>(hand.secondary) };
+				all_card[entry.primary] += entry.weight;
+				all_card[entry.secondary] += entry.weight;
+				all_total += entry.weight;
+				vill_entries.push_back(entry);
+			}
+
+			std::sort(hero_entries.begin(), hero_entries.end());
+			std::sort(vill_entries.begin(), vill_entries.end());
+
+			// the mass below and equal to the current hero strength, both in total and per card,
+			// corrects for card removal without pairing up combos
+			std::array<double, Variant::deck_size> lt_card = { 0 };
+			std::array<double, Variant::deck_size> eq_card = { 0 };
+			double lt_total = 0;
+			double eq_total = 0;
+			int strength = -1;
+			size_t j = 0;
+
+			for (const RangeEntry& entry : hero_entries) {
+				if (entry.strength != strength) {
+					strength = entry.strength;
+
+					for (; j < vill_entries.size() && vill_entries[j].strength < strength; ++j) {
+						lt_card[vill_entries[j].primary] += vill_entries[j].weight;
+						lt_card[vill_entries[j].secondary] += vill_entries[j].weight;
+						lt_total += vill_entries[j].weight;
+					}
+
+					eq_card = { 0 };
+					eq_total = 0;
+					for (size_t k = j; k < vill_entries.size() && vill_entries[k].strength == strength; ++k) {
+						eq_card[vill_entries[k].primary] += vill_entries[k].weight;
+						eq_card[vill_entries[k].secondary] += vill_entries[k].weight;
+						eq_total += vill_entries[k].weight;
+					}
+				}
+
+				// the identical combo is removed twice by the per-card correction and always ties
+				double same = vill_weights[hero_indices[entry.combo]];
+				double win = lt_total - lt_card[entry.primary] - lt_card[entry.secondary];
+				double tie = eq_total - eq_card[entry.primary] - eq_card[entry.secondary] + same;
+				double valid = all_total - all_card[entry.primary] - all_card[entry.secondary] + same;
+
+				wins[entry.combo] += win + tie / 2;
+				totals[entry.combo] += valid;
+			}
+		};
+
+		for_each_runout<Variant>(runout, board_size, 0, dead, visit);
+
+		RangeEquity result;
+		result.combo_equities.resize(hero.size(), 0);
+		double weighted_wins = 0;
+		double weighted_totals = 0;
+		for (int i = 0; i < hero.size(); ++i) {
+			if (totals[i] > 0) result.combo_equities[i] = wins[i] / totals[i];
+			weighted_wins += hero.weight(i) * wins[i];
+			weighted_totals += hero.weight(i) * totals[i];
+		}
+		result.equity = weighted_totals > 0 ? weighted_wins / weighted_totals : 0;
+
+		return result;
+	}
+
+
+
+	// LiveEquitySolver
+
+	template<class Variant>
+	double BasicLiveEquitySolver<Variant>::enumerate(const PokerHand& hero, const PokerHand& vill, const Board& board)
+	{
+		reset();
+
+		SuitMasks hero_masks = { 0 };
+		uint64_t dead = 0;
+		for (const Card& card : board) {
+			add_card(hero_masks, to_slim_card(card));
+			dead |= card_mask(card_to_index<Variant>(card));
+		}
+		SuitMasks vill_masks = hero_masks;
+
+		add_card(hero_masks, to_slim_card(hero.get_primary()));
+		add_card(hero_masks, to_slim_card(hero.get_secondary()));
+		add_card(vill_masks, to_slim_card(vill.get_primary()));
+		add_card(vill_masks, to_slim_card(vill.get_secondary()));
+		dead |= card_mask(card_to_index<Variant>(hero.get_primary())) | card_mask(card_to_index<Variant>(hero.get_secondary()))
+			| card_mask(card_to_index<Variant>(vill.get_primary())) | card_mask(card_to_index<Variant>(vill.get_secondary()));
+
+		enumerate_runouts(hero_masks, vill_masks, Board::capacity - board.size(), 0, dead);
+		return calc_equity();
+	}
+
+	template<class Variant>
+	void BasicLiveEquitySolver<Variant>::enumerate_runouts(const SuitMasks& hero, const SuitMasks& vill, int missing, int start, uint64_t dead)
+	{
+		if (!missing) {
+			int result = BasicStrengthEvaluator<Variant>::evaluate(hero) - BasicStrengthEvaluator<Variant>::evaluate(vill);
+			add_result(result > 0 ? Winner::HERO : result < 0 ? Winner::VILL : Winner::SPLIT);
+			return;
+		}
+
+		for (int i = start; i < Variant::deck_size; ++i) {
+			if (dead & card_mask(i)) continue;
+
+			SlimCard card = index_to_slim_card<Variant>(i);
+			SuitMasks next_hero = hero;
+			SuitMasks next_vill = vill;
+			add_card(next_hero, card);
+			add_card(next_vill, card);
+			enumerate_runouts(next_hero, next_vill, missing - 1, i + 1, dead);
+		}
+	}
+
+	template class BasicCachedEquitySolver<Holdem>;
+	template class BasicCachedEquitySolver<ShortDeck>;
+	template class BasicLiveEquitySolver<Holdem>;
+	template class BasicLiveEquitySolver<ShortDeck>;
+}
\ No newline at end of file
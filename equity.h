@@ -1,32 +1,123 @@
 #pragma once
 
 #include "evaluator.h"
+#include "lookup_evaluator.h"
+#include "table_allocator.h"
 
 #include <memory>
 #include <array>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <utility>
+#include <vector>
 
 namespace Poker {
+	// utility
+
+	template<class Variant = Holdem>
+	int card_to_index(const Card& card)
+	{
+		return card_index<Variant>(static_cast<int>(card.get_rank()), static_cast<int>(card.get_suit()));
+	}
+
+	template<class Variant = Holdem>
+	char slim_card_to_index(const SlimCard& card)
+	{
+		return card_index<Variant>(card.rank, card.suit);
+	}
+
+	template<class Variant = Holdem>
+	SlimCard index_to_slim_card(char index)
+	{
+		return SlimCard{ static_cast<char>(index / 4 + Variant::min_rank), static_cast<char>(index % 4) };
+	}
+
+	inline int arith_series(int n)
+	{
+		return n * (n + 1) / 2;
+	}
+
+	// Either card order gives the same index.
+	template<class Variant = Holdem>
+	int hand_to_index(const PokerHand& hand)
+	{
+		int primary = card_to_index<Variant>(hand.get_primary());
+		int secondary = card_to_index<Variant>(hand.get_secondary());
+		if (primary < secondary) std::swap(primary, secondary);
+		return arith_series(primary - 1) + secondary;
+	}
+
+	template<class Variant = Holdem>
+	int hand_to_index(const SlimHand& hand)
+	{
+		int primary = slim_card_to_index<Variant>(hand.primary);
+		int secondary = slim_card_to_index<Variant>(hand.secondary);
+		if (primary < secondary) std::swap(primary, secondary);
+		return arith_series(primary - 1) + secondary;
+	}
+
+	inline uint64_t card_mask(int index) { return uint64_t{ 1 } << index; }
+
+	// Calls visit for every completion of the first size cards of runout to five cards that avoids dead.
+	template<class Variant = Holdem, class Visitor>
+	void for_each_runout(std::array<char, 5>& runout, int size, int start, uint64_t dead, Visitor& visit)
+	{
+		if (size == 5) {
+			visit(runout);
+			return;
+		}
+
+		for (int i = start; i < Variant::deck_size; ++i) {
+			if (dead & card_mask(i)) continue;
+
+			runout[size] = i;
+			for_each_runout<Variant>(runout, size + 1, i + 1, dead, visit);
+		}
+	}
+
 	enum class Winner {
 		HERO, VILL, SPLIT
 	};
 
-	struct SlimBoard {
-	public:
-		SlimBoard() : m_size{ 0 } {}
-		SlimBoard(SlimCard c_1, SlimCard c_2, SlimCard c_3, SlimCard c_4, SlimCard c_5) : board{ c_1, c_2, c_3, c_4, c_5 } {}
+	// Exact outcome counts over part of the board table; counts from disjoint parts add up.
+	struct ShardCounts {
+		uint64_t wins = 0;
+		uint64_t ties = 0;
+		uint64_t losses = 0;
+
+		uint64_t total() const { return wins + ties + losses; }
+		double equity() const { return (wins + ties / 2.0) / total(); }
+
+		ShardCounts& operator+=(const ShardCounts& other)
+		{
+			wins += other.wins;
+			ties += other.ties;
+			losses += other.losses;
+			return *this;
+		}
+	};
 
-		SlimCard& operator[](char i) { return board[i]; }
-		const SlimCard& operator[](char i) const { return board[i]; }
-		char size() const { return m_size; }
-		void add_card(SlimCard card) { board[m_size++] = card; }
-		void pop_card() { --m_size; }
+	// Result of a deadline-bounded enumerate. Until every board has been visited, equity is an
+	// unbiased estimate and error a ~95% bound on its distance from the exact value.
+	struct AnytimeEquity {
+		double equity = 0;
+		// share of the boards consistent with the known cards that were evaluated
+		double coverage = 0;
+		double error = 0;
+		bool complete = false;
+	};
 
-		std::array<SlimCard, 5>::const_iterator begin() const { return board.cbegin(); }
-		std::array<SlimCard, 5>::const_iterator end() const { return board.cend(); }
+	// Board table entries that stand for their whole orbit under relabeling the suits within each
+	// class of a suit partition, with the size of that orbit.
+	struct SymmetricBoards {
+		std::vector<uint32_t> indices;
+		std::vector<uint8_t> weights;
+	};
 
-	private:
-		std::array<SlimCard, 5> board;
-		char m_size;
+	struct RangeEquity {
+		double equity = 0;
+		std::vector<double> combo_equities;
 	};
 
 	class EquitySolver {
@@ -48,27 +139,85 @@ namespace Poker {
 		int count = 0;
 	};
 
-	class CachedEquitySolver : public EquitySolver {
+	template<class Variant>
+	class BasicCachedEquitySolver : public EquitySolver {
 	public:
-		CachedEquitySolver(bool test);
+		BasicCachedEquitySolver(bool test, TableOptions options = TableOptions(), EvaluatorEngine engine = EvaluatorEngine::CACHED);
+		// Copies share the board table, so each worker thread can hold its own solver.
+		BasicCachedEquitySolver(const BasicCachedEquitySolver& other);
+		BasicCachedEquitySolver& operator=(const BasicCachedEquitySolver&) = delete;
+
 		Winner test(const PokerHand& hero, const PokerHand& vill, const Board& board);
 		double enumerate(const PokerHand& hero, const PokerHand& vill, const Board& board = Board());
+		RangeEquity enumerate(const PokerRange& hero, const PokerRange& vill, const Board& board = Board());
+		// Counts over the board table entries [begin, end); the full range matches enumerate().
+		ShardCounts enumerate(const PokerHand& hero, const PokerHand& vill, const Board& board, size_t begin, size_t end);
+		// Visits the board table in a low-discrepancy order from a random start and stops once
+		// budget has elapsed; with enough time the answer is exact.
+		AnytimeEquity enumerate(const PokerHand& hero, const PokerHand& vill, const Board& board, std::chrono::nanoseconds budget);
+		// Sign of hero's strength minus villain's on a complete board, evaluated by the engine straight from the table.
+		int showdown(const PokerHand& hero, const PokerHand& vill, const Board& board);
+
+		size_t board_count() const { return all_boards->size(); }
 
 	private:
-		void cache_boards_r(int start_index);
+		void set_hands(const PokerHand& hero, const PokerHand& vill, const Board& board);
+		void cache_rank_classes(std::vector<uint16_t>& class_ids);
+		void cache_boards(int begin, int end, const std::vector<uint16_t>& class_ids);
 		void cache_hands();
 
-		CachedEvaluator evaluator;
-		std::vector<BoardCache> all_boards;
+		const SymmetricBoards* symmetric_boards(const Board& board);
+
+		template<class Evaluator>
+		double enumerate_boards(Evaluator& evaluator);
+		template<class Evaluator>
+		double enumerate_boards(Evaluator& evaluator, const SymmetricBoards& symmetric);
+		template<class Evaluator>
+		ShardCounts count_boards(Evaluator& evaluator, size_t begin, size_t end);
+		template<class Evaluator>
+		AnytimeEquity sample_boards(Evaluator& evaluator, std::chrono::steady_clock::time_point deadline);
+
+		EvaluatorEngine engine;
+		BasicCachedEvaluator<Variant> evaluator;
+		LookupEvaluator lookup_evaluator;
+		std::shared_ptr<const LookupTable> lookup_table;
+		std::shared_ptr<NumaTable<BoardCache>> all_boards;
+		std::shared_ptr<std::vector<RankClass>> all_rank_classes;
+		// canonical boards per suit partition, built on first use and shared by every copy
+		struct SymmetryCache {
+			std::mutex mutex;
+			std::array<std::shared_ptr<const SymmetricBoards>, 64> partitions;
+		};
+		std::shared_ptr<SymmetryCache> symmetry_cache;
 		std::vector<HandCache> all_hands;
-		std::array<char, 52> hand_ranks;
+		std::array<char, Variant::deck_size> hand_ranks;
+		char known_cards = 0;
+		// table indices of the boards consistent with a postflop query, ascending; reused across queries
+		std::vector<uint32_t> runout_boards;
 
-		BoardCache* board_cache = nullptr;
+		const BoardCache* board_cache = nullptr;
+		const RankClass* rank_classes = nullptr;
 		HandCache* hero_cache = nullptr;
 		HandCache* vill_cache = nullptr;
+		const LookupTable* lookup = nullptr;
+		std::mt19937_64 rng{ std::random_device()() };
+	};
+
+	using CachedEquitySolver = BasicCachedEquitySolver<Holdem>;
+	using ShortDeckEquitySolver = BasicCachedEquitySolver<ShortDeck>;
 
-		SlimBoard board;
-		std::array<char, 15> temp_ranks;
-		int index = 0;
+	// Evaluates the remaining runouts straight from the live deck, with no board table to build.
+	// Meant for turn and river spots, where at most a few dozen runouts are left; every call on an
+	// earlier street is a full enumeration.
+	template<class Variant>
+	class BasicLiveEquitySolver : public EquitySolver {
+	public:
+		double enumerate(const PokerHand& hero, const PokerHand& vill, const Board& board);
+
+	private:
+		void enumerate_runouts(const SuitMasks& hero, const SuitMasks& vill, int missing, int start, uint64_t dead);
 	};
+
+	using LiveEquitySolver = BasicLiveEquitySolver<Holdem>;
+	using ShortDeckLiveEquitySolver = BasicLiveEquitySolver<ShortDeck>;
 }
\ No newline at end of file
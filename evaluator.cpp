@@ -3,236 +3,225 @@
 #include <algorithm>
 
 namespace Poker {
-	// CachedEvaluator
+	// StrengthEvaluator
 
-	void CachedEvaluator::process_flush(Props& props)
+	int high_bit(int mask)
 	{
-		props.is_flush = board_cache->suit_count + props.cache->suits[board_cache->max_suit] >= 5;
+		return 31 - __builtin_clz(mask);
 	}
 
-	void CachedEvaluator::process_straight(Props& props)
+	int top_ranks(int mask, int count)
 	{
-		props.hand_ranks[0] = props.cache->hand.primary.rank;
-		props.hand_ranks[1] = props.cache->hand.secondary.rank;
-
-		props.straight_rank = board_cache->straights[props.hand_ranks[0] - 2][props.hand_ranks[1] - 2];
-		props.is_straight = props.straight_rank != 1;
+		int ranks = 0;
+		for (int i = 0; i < count; ++i) {
+			int rank = high_bit(mask);
+			ranks = (ranks << 4) | rank;
+			mask ^= 1 << rank;
+		}
+		return ranks << (4 * (5 - count));
 	}
 
-	void CachedEvaluator::process_matches()
+	template<class Variant>
+	int straight_top(int mask)
 	{
-		hero.match_counts = { 0 };
-		vill.match_counts = { 0 };
+		mask |= (mask >> 14 & 1) << (Variant::min_rank - 1);
+		int run = mask & (mask >> 1) & (mask >> 2) & (mask >> 3) & (mask >> 4);
+		return run ? high_bit(run) + 4 : 0;
+	}
 
-		char count;
-		char index;
-		for (auto& entry : board_cache->ranks) {
-			index = entry.first;
+	template<class Variant>
+	int category_order(HandCategory category)
+	{
+		if constexpr (Variant::flush_beats_full_house) {
+			if (category == HandCategory::FLUSH) return static_cast<int>(HandCategory::FULL_HOUSE);
+			if (category == HandCategory::FULL_HOUSE) return static_cast<int>(HandCategory::FLUSH);
+		}
+		return static_cast<int>(category);
+	}
 
-			count = hero.cache->ranks[index] + entry.second - 1;
-			hero.matches[count][hero.match_counts[count]++] = index;
+	template<class Variant>
+	int make_strength(HandCategory category, int ranks)
+	{
+		return (category_order<Variant>(category) << 20) | ranks;
+	}
 
-			count = vill.cache->ranks[index] + entry.second - 1;
-			vill.matches[count][vill.match_counts[count]++] = index;
-		}
+	template<class Variant>
+	HandCategory BasicStrengthEvaluator<Variant>::category(int strength)
+	{
+		// category_order is its own inverse
+		return static_cast<HandCategory>(category_order<Variant>(static_cast<HandCategory>(strength >> 20)));
 	}
 
-	void CachedEvaluator::init_royal_flush(Props& props)
+	template<class Variant>
+	int BasicStrengthEvaluator<Variant>::evaluate(const SuitMasks& masks)
 	{
-		if (!props.is_flush || !props.is_straight) {
-			props.is_royal = false;
-			return;
-		}
+		for (int suit = 0; suit < 4; ++suit) {
+			if (__builtin_popcount(masks[suit]) >= 5) {
+				int top = straight_top<Variant>(masks[suit]);
+				if (top) return make_strength<Variant>(HandCategory::STRAIGHT_FLUSH, top << 16);
 
-		props.cards = {
-			props.cache->hand.primary, props.cache->hand.secondary,
-			board_cache->board[0], board_cache->board[1], board_cache->board[2],
-			board_cache->board[3], board_cache->board[4]
-		};
-		std::sort(props.cards.rbegin(), props.cards.rend());
+				// with at most 7 cards a flush rules out quads and full houses
+				return make_strength<Variant>(HandCategory::FLUSH, top_ranks(masks[suit], 5));
+			}
+		}
 
-		if (props.straight_rank != 14) {
-			props.is_royal = false;
-			return;
+		int s_0 = masks[0], s_1 = masks[1], s_2 = masks[2], s_3 = masks[3];
+		int all = s_0 | s_1 | s_2 | s_3;
+		int quads = s_0 & s_1 & s_2 & s_3;
+		int threes = (s_0 & s_1 & s_2) | (s_0 & s_1 & s_3) | (s_0 & s_2 & s_3) | (s_1 & s_2 & s_3);
+		int twos = (s_0 & s_1) | (s_0 & s_2) | (s_0 & s_3) | (s_1 & s_2) | (s_1 & s_3) | (s_2 & s_3);
+		int trips = threes & ~quads;
+		int pairs = twos & ~threes;
+
+		if (quads) {
+			int quad = high_bit(quads);
+			return make_strength<Variant>(HandCategory::QUADS, (quad << 16) | (high_bit(all ^ (1 << quad)) << 12));
 		}
 
-		int counter = 0;
-		for (auto& card : props.cards) {
-			if (card.rank < 10) {
-				props.is_royal = false;
-				break;
-			}
-			if (card.suit == board_cache->max_suit) {
-				++counter;
+		if (trips) {
+			int trip = high_bit(trips);
+			int rest = (trips ^ (1 << trip)) | pairs;
+			if (rest) {
+				return make_strength<Variant>(HandCategory::FULL_HOUSE, (trip << 16) | (high_bit(rest) << 12));
 			}
 		}
 
-		props.is_royal = counter == 5;
-	}
+		int top = straight_top<Variant>(all);
+		if (top) return make_strength<Variant>(HandCategory::STRAIGHT, top << 16);
 
-	void CachedEvaluator::init_straight_flush(Props& props)
-	{
-		if (!props.is_flush || !props.is_straight) {
-			props.is_strf = false;
-			return;
+		if (trips) {
+			int trip = high_bit(trips);
+			return make_strength<Variant>(HandCategory::TRIPS, (trip << 16) | (top_ranks(all ^ (1 << trip), 2) >> 4));
 		}
 
-		char curr_rank;
-		int counter = 0;
-		for (int i = 0; i < 7; ++i) {
-			curr_rank = props.cards[i].rank;
-			if (curr_rank > props.straight_rank) {
-				continue;
-			}
-			if (props.cards[i].suit != board_cache->max_suit) {
-				continue;
-			}
-
-			if (curr_rank != props.straight_rank - counter) {
-				if (i > 2) {
-					props.is_strf = false;
-					return;
-				}
-				counter = 1;
-				props.straight_rank = curr_rank;
-			}
-			else {
-				++counter;
-				if (counter == 5) break;
-			}
+		if (pairs && (pairs & (pairs - 1))) {
+			int high = high_bit(pairs);
+			int low = high_bit(pairs ^ (1 << high));
+			int kicker = high_bit(all ^ (1 << high) ^ (1 << low));
+			return make_strength<Variant>(HandCategory::TWO_PAIR, (high << 16) | (low << 12) | (kicker << 8));
 		}
 
-		if (counter == 4 && props.straight_rank == 5) {
-			for (auto& card : props.cards) {
-				if (card.rank < 14) {
-					props.is_strf = false;
-					return;
-				}
-				if (card.rank == 14 && card.suit == board_cache->max_suit) {
-					props.is_strf = true;
-					return;
-				}
-			}
+		if (pairs) {
+			int pair = high_bit(pairs);
+			return make_strength<Variant>(HandCategory::PAIR, (pair << 16) | (top_ranks(all ^ (1 << pair), 3) >> 4));
 		}
 
-		props.is_strf = counter == 5;
+		return make_strength<Variant>(HandCategory::HIGH_CARD, top_ranks(all, 5));
 	}
 
-	void CachedEvaluator::init_quads()
+
+	// CachedEvaluator
+
+	// First take ranks of a match list packed into nibbles, so tie breaks compare as integers.
+	int pack_ranks(const std::array<char, 7>& ranks, int take)
 	{
-		for (auto& card : board_cache->board) {
-			if (card.rank != hero.matches[3][0]) {
-				min_ranks[0] = card.rank + 1;
-				break;
-			}
-		}
+		int packed = 0;
+		for (int i = 0; i < take; ++i) packed = (packed << 4) | ranks[i];
+		return packed;
 	}
 
-	void CachedEvaluator::init_flush()
+	template<class Variant>
+	void BasicCachedEvaluator<Variant>::process_flush(Props& props)
 	{
-		int index = 5 - board_cache->suit_count;
-		min_ranks[0] = 1;
+		props.is_flush = board_cache->suit_count + props.cache->suits[board_cache->max_suit] >= 5;
+		props.flush_ranks = 0;
+		props.strf_rank = 0;
+		if (!props.is_flush) return;
 
-		for (int i = 4; index < 1; --i) {
-			if (board_cache->board[i].suit == board_cache->max_suit) {
-				min_ranks[index] = board_cache->board[i].rank;
-				break;
-			}
+		int ranks = 0;
+		for (const SlimCard& card : board_cache->board) {
+			if (card.suit == board_cache->max_suit) ranks |= 1 << card.rank;
 		}
+		const SlimHand& hand = props.cache->hand;
+		if (hand.primary.suit == board_cache->max_suit) ranks |= 1 << hand.primary.rank;
+		if (hand.secondary.suit == board_cache->max_suit) ranks |= 1 << hand.secondary.rank;
+
+		props.strf_rank = static_cast<char>(straight_top<Variant>(ranks));
+		// only the five highest cards of the suit play
+		while (__builtin_popcount(ranks) > 5) ranks &= ranks - 1;
+		props.flush_ranks = ranks;
 	}
 
-	void CachedEvaluator::init_trips()
+	template<class Variant>
+	void BasicCachedEvaluator<Variant>::process_straight(Props& props)
 	{
-		int counter = -hero.cache->ranks[hero.matches[2][0]];
-
-		for (int i = 4; counter < 2; --i) {
-			if (board_cache->board[i].rank != hero.matches[2][0]) {
-				if (counter >= 0) {
-					min_ranks[counter] = board_cache->board[i].rank;
-				}
-				++counter;
-			}
-		}
-	}
+		props.hand_ranks[0] = props.cache->hand.primary.rank;
+		props.hand_ranks[1] = props.cache->hand.secondary.rank;
 
-	void CachedEvaluator::init_two_pair()
-	{
-		int i = 0;
-		for (; board_cache->board[i].rank == hero.matches[1][0] || board_cache->board[i].rank == hero.matches[1][1]; ++i) {}
-		min_ranks[0] = board_cache->board[i].rank;
+		int ranks = rank_cache->rank_mask | 1 << props.hand_ranks[0] | 1 << props.hand_ranks[1];
+		props.straight_rank = static_cast<char>(straight_top<Variant>(ranks));
+		props.is_straight = props.straight_rank != 0;
 	}
 
-	void CachedEvaluator::init_pair()
+	template<class Variant>
+	void BasicCachedEvaluator<Variant>::add_match(Props& props, char rank, int count)
 	{
-		//int hand_count = -hero.ranks[static_cast<int>(hero.matches[1][0])];
-
-		//if (hand_count == -2) {
-		//	return;
-		//}
-
-		//min_ranks[0] = CardRank::PLACEHOLDER;
-		//min_ranks[1] = CardRank::PLACEHOLDER;
-
-		//for (int i = 4; hand_count < 2; --i) {
-		//	if (board_cache->board[i].get_rank() != hero.matches[1][0]) {
-		//		if (hand_count >= 0) {
-		//			min_ranks[hand_count] = board_cache->board[i].get_rank();
-		//		}
-		//		++hand_count;
-		//	}
-		//}
-
-		min_ranks[0] = hero.matches[0][hero.match_counts[0] - 1];
-		min_ranks[1] = hero.matches[0][hero.match_counts[0] - 2];
+		props.matches[count - 1][props.match_counts[count - 1]++] = rank;
 	}
 
-	bool CachedEvaluator::check_royal()
+	template<class Variant>
+	void BasicCachedEvaluator<Variant>::process_matches(Props& props)
 	{
-		init_royal_flush(hero);
-		init_royal_flush(vill);
+		props.match_counts = { 0 };
+
+		// hole ranks are merged into the board's descending rank list; the hand cache keeps the
+		// primary card at least as high as the secondary
+		const std::array<char, 15>& hole = props.cache->ranks;
+		std::array<char, 2> hole_ranks = { props.hand_ranks[0], props.hand_ranks[1] };
+		int hole_count = hole_ranks[0] == hole_ranks[1] ? 1 : 2;
+		int next = 0;
+
+		for (int i = 0; i < rank_cache->rank_count; ++i) {
+			const auto& entry = rank_cache->ranks[i];
+			for (; next < hole_count && hole_ranks[next] > entry.first; ++next) {
+				add_match(props, hole_ranks[next], hole[hole_ranks[next]]);
+			}
+			if (next < hole_count && hole_ranks[next] == entry.first) ++next;
 
-		if (!hero.is_royal && !vill.is_royal) {
-			return false;
+			add_match(props, entry.first, hole[entry.first] + entry.second);
+		}
+		for (; next < hole_count; ++next) {
+			add_match(props, hole_ranks[next], hole[hole_ranks[next]]);
 		}
-
-		result = hero.is_royal - vill.is_royal;
-
-		return true;
 	}
 
-	bool CachedEvaluator::check_strf()
+	template<class Variant>
+	bool BasicCachedEvaluator<Variant>::check_strf()
 	{
-		init_straight_flush(hero);
-		init_straight_flush(vill);
-
-		if (!hero.is_strf && !vill.is_strf) {
+		if (!hero.strf_rank && !vill.strf_rank) {
 			return false;
 		}
 
-		result = hero.is_strf * hero.straight_rank - vill.is_strf * vill.straight_rank;
+		result = hero.strf_rank - vill.strf_rank;
 
 		return true;
 	}
 
-	bool CachedEvaluator::check_quads()
+	template<class Variant>
+	bool BasicCachedEvaluator<Variant>::check_quads()
 	{
 		if (!hero.match_counts[3] && !vill.match_counts[3]) {
 			return false;
 		}
 
 		result = hero.match_counts[3] * hero.matches[3][0] - vill.match_counts[3] * vill.matches[3][0];
+		if (result != 0) return true;
 
-		if (result == 0) {
-			init_quads();
-
-			result = (hero.hand_ranks[0] / min_ranks[0]) * static_cast<int>(hero.hand_ranks[0])
-				- (vill.hand_ranks[0] / min_ranks[0]) * static_cast<int>(vill.hand_ranks[0]);
-		}
+		// the same quads can only come from the board, so the best other card decides
+		auto kicker = [](const Props& props) {
+			char best = 0;
+			for (int count = 0; count < 3; ++count) {
+				if (props.match_counts[count]) best = std::max(best, props.matches[count][0]);
+			}
+			return best;
+		};
+		result = kicker(hero) - kicker(vill);
 
 		return true;
 	}
 
-	bool CachedEvaluator::check_full_house()
+	template<class Variant>
+	bool BasicCachedEvaluator<Variant>::check_full_house()
 	{
 		hero.is_full_house = (hero.match_counts[2] == 1 && hero.match_counts[1] >= 1) || hero.match_counts[2] == 2;
 		vill.is_full_house = (vill.match_counts[2] == 1 && vill.match_counts[1] >= 1) || vill.match_counts[2] == 2;
@@ -244,34 +233,30 @@ namespace Poker {
 		result = hero.is_full_house * hero.matches[2][0] - vill.is_full_house * vill.matches[2][0];
 		if (result != 0) return true;
 
-		if (hero.match_counts[2] == 2) hero.matches[1][0] = hero.matches[2][1];
-		if (vill.match_counts[2] == 2) vill.matches[1][0] = vill.matches[2][1];
-		result = hero.matches[1][0] - vill.matches[1][0];
+		// a second set of trips plays as the pair
+		auto pair = [](const Props& props) {
+			return props.match_counts[2] == 2 ? props.matches[2][1] : props.matches[1][0];
+		};
+		result = pair(hero) - pair(vill);
 
 		return true;
 	}
 
-	bool CachedEvaluator::check_flush()
+	template<class Variant>
+	bool BasicCachedEvaluator<Variant>::check_flush()
 	{
 		if (!hero.is_flush && !vill.is_flush) {
 			return false;
 		}
 
-		result = hero.is_flush - vill.is_flush;
-		if (result != 0) return true;
-
-		init_flush();
-
-		int index_h = (hero.cache->hand.primary.suit != board_cache->max_suit) << (hero.cache->hand.secondary.suit != board_cache->max_suit);
-		int index_v = (vill.cache->hand.primary.suit != board_cache->max_suit) << (vill.cache->hand.secondary.suit != board_cache->max_suit);
-
-		result = (vill.hand_ranks[index_v] / min_ranks[0]) * static_cast<int>(vill.hand_ranks[index_v]) * (index_v - 2)
-			- (hero.hand_ranks[index_h] / min_ranks[0]) * static_cast<int>(hero.hand_ranks[index_h]) * (index_h - 2);
+		// higher top cards give a higher mask
+		result = hero.flush_ranks - vill.flush_ranks;
 
 		return true;
 	}
 
-	bool CachedEvaluator::check_straight()
+	template<class Variant>
+	bool BasicCachedEvaluator<Variant>::check_straight()
 	{
 		if (!hero.is_straight && !vill.is_straight) {
 			return false;
@@ -282,101 +267,87 @@ namespace Poker {
 		return true;
 	}
 
-	bool CachedEvaluator::check_trips()
+	template<class Variant>
+	bool BasicCachedEvaluator<Variant>::check_trips()
 	{
-		if (!hero.match_counts[2] & !vill.match_counts[2]) {
+		if (!hero.match_counts[2] && !vill.match_counts[2]) {
 			return false;
 		}
 
 		result = hero.match_counts[2] * hero.matches[2][0] - vill.match_counts[2] * vill.matches[2][0];
+		if (result != 0) return true;
 
-		if (result == 0) {
-			init_trips();
-
-			int index = 0;
-			do {
-				result = (hero.hand_ranks[index] / min_ranks[index]) * static_cast<int>(hero.hand_ranks[index])
-					   - (vill.hand_ranks[index] / min_ranks[index]) * static_cast<int>(vill.hand_ranks[index]);
-				++index;
-			} while (result == 0 && index < 2);
-		}
+		result = pack_ranks(hero.matches[0], 2) - pack_ranks(vill.matches[0], 2);
 
 		return true;
 	}
 
-	bool CachedEvaluator::check_two_pair()
+	template<class Variant>
+	bool BasicCachedEvaluator<Variant>::check_two_pair()
 	{
 		if (hero.match_counts[1] < 2 && vill.match_counts[1] < 2) {
 			return false;
 		}
 
-		result = (hero.match_counts[1] / 2) * hero.matches[1][0] - (vill.match_counts[1] / 2) * vill.matches[1][0];
-		if (result != 0) return true;
-
-		result = (hero.match_counts[1] / 2) * hero.matches[1][1] - (vill.match_counts[1] / 2) * vill.matches[1][1];
+		result = (hero.match_counts[1] >= 2) * pack_ranks(hero.matches[1], 2) - (vill.match_counts[1] >= 2) * pack_ranks(vill.matches[1], 2);
 		if (result != 0) return true;
 
-		init_two_pair();
-
-		int index_h = hero.hand_ranks[0] == hero.matches[1][0] || hero.hand_ranks[0] == hero.matches[1][1];
-		int index_v = vill.hand_ranks[0] == vill.matches[1][0] || vill.hand_ranks[0] == vill.matches[1][1];
-		result = (hero.hand_ranks[index_h] / min_ranks[0]) * static_cast<int>(hero.hand_ranks[index_h])
-			- (vill.hand_ranks[index_v] / min_ranks[0]) * static_cast<int>(vill.hand_ranks[index_v]);
+		// a third pair can outrank the best single as the kicker
+		auto kicker = [](const Props& props) {
+			char single = props.match_counts[0] ? props.matches[0][0] : 0;
+			return props.match_counts[1] == 3 ? std::max(props.matches[1][2], single) : single;
+		};
+		result = kicker(hero) - kicker(vill);
 
 		return true;
 	}
 
-	bool CachedEvaluator::check_pair()
+	template<class Variant>
+	bool BasicCachedEvaluator<Variant>::check_pair()
 	{
-		if (!hero.match_counts[1] & !vill.match_counts[1]) {
+		if (!hero.match_counts[1] && !vill.match_counts[1]) {
 			return false;
 		}
 
 		result = hero.match_counts[1] * hero.matches[1][0] - vill.match_counts[1] * vill.matches[1][0];
+		if (result != 0) return true;
 
-		if (result == 0) {
-			init_pair();
-
-			int index = 0;
-			do {
-				result = (hero.hand_ranks[index] / min_ranks[index]) * static_cast<int>(hero.hand_ranks[index])
-					- (vill.hand_ranks[index] / min_ranks[index]) * static_cast<int>(vill.hand_ranks[index]);
-				++index;
-			} while (result == 0 && index < 2);
-		}
+		result = pack_ranks(hero.matches[0], 3) - pack_ranks(vill.matches[0], 3);
 
 		return true;
 	}
 
-	void CachedEvaluator::check_high_card()
+	template<class Variant>
+	void BasicCachedEvaluator<Variant>::check_high_card()
 	{
-		char min_rank_1 = board_cache->board[4].rank;
-		char min_rank_2 = board_cache->board[3].rank;
-
-		int index = 0;
-		do {
-			result = (hero.hand_ranks[index] / min_ranks[index]) * static_cast<int>(hero.hand_ranks[index])
-				- (vill.hand_ranks[index] / min_ranks[index]) * static_cast<int>(vill.hand_ranks[index]);
-			++index;
-		} while (result == 0 && index < 2);
+		result = pack_ranks(hero.matches[0], 5) - pack_ranks(vill.matches[0], 5);
 	}
 
-	int CachedEvaluator::evaluate()
+	template<class Variant>
+	int BasicCachedEvaluator<Variant>::evaluate()
 	{
+		rank_cache = rank_classes + board_cache->rank_class;
+
 		process_flush(hero);
 		process_flush(vill);
 
 		process_straight(hero);
 		process_straight(vill);
 
-		if (check_royal()) return result;
 		if (check_strf()) return result;
 
-		process_matches();
+		process_matches(hero);
+		process_matches(vill);
 
 		if (check_quads()) return result;
-		if (check_full_house()) return result;
-		if (check_flush()) return result;
+		if constexpr (Variant::flush_beats_full_house) {
+			if (check_flush()) return result;
+			if (check_full_house()) return result;
+		}
+		else {
+			if (check_full_house()) return result;
+			if (check_flush()) return result;
+		}
 		if (check_straight()) return result;
 		if (check_trips()) return result;
 		if (check_two_pair()) return result;
@@ -385,4 +356,10 @@ namespace Poker {
 
 		return result;
 	}
-}
+
+
+	template class BasicStrengthEvaluator<Holdem>;
+	template class BasicStrengthEvaluator<ShortDeck>;
+	template class BasicCachedEvaluator<Holdem>;
+	template class BasicCachedEvaluator<ShortDeck>;
+}
\ No newline at end of file
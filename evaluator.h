@@ -1,9 +1,12 @@
 #pragma once
 
 #include "poker_game.h"
+#include "variant.h"
 
 #include <array>
+#include <cstdint>
 #include <map>
+#include <stdexcept>
 #include <utility>
 
 namespace Poker {
@@ -20,16 +23,113 @@ namespace Poker {
 	inline bool operator>=(const SlimCard& hero, const SlimCard& vill) { return hero > vill || hero == vill; }
 	inline bool operator<=(const SlimCard& hero, const SlimCard& vill) { return hero < vill || hero == vill; }
 
+	inline SlimCard to_slim_card(const Card& card)
+	{
+		return SlimCard{ static_cast<char>(card.get_rank()), static_cast<char>(card.get_suit()) };
+	}
+
 	struct SlimHand {
 		SlimCard primary;
 		SlimCard secondary;
 	};
 
+	enum class HandCategory : char {
+		HIGH_CARD = 0,
+		PAIR = 1,
+		TWO_PAIR = 2,
+		TRIPS = 3,
+		STRAIGHT = 4,
+		FLUSH = 5,
+		FULL_HOUSE = 6,
+		QUADS = 7,
+		STRAIGHT_FLUSH = 8
+	};
+
+	// Per-suit rank bitmasks (bit r set for rank r), shared by the absolute strength evaluators.
+	using SuitMasks = std::array<uint16_t, 4>;
+
+	inline void add_card(SuitMasks& masks, const SlimCard& card) { masks[card.suit] |= 1 << card.rank; }
+
+	inline SuitMasks to_suit_masks(const Board& board)
+	{
+		SuitMasks masks = { 0 };
+		for (const Card& card : board) add_card(masks, to_slim_card(card));
+		return masks;
+	}
+
+	// Scores 5 to 7 cards into a single comparable int (category << 20 | five rank nibbles),
+	// so a strength can be computed once per hand and board and compared against many opponents.
+	template<class Variant>
+	class BasicStrengthEvaluator {
+	public:
+		static int evaluate(const SuitMasks& masks);
+		static HandCategory category(int strength);
+	};
+
+	using StrengthEvaluator = BasicStrengthEvaluator<Holdem>;
+
+	struct StreetStrength {
+		HandCategory category;
+		int strength;
+	};
+
+	// What a hand holds right now on a partial board. The board size is a template constant,
+	// so each street gets its own unrolled card gathering with no loop over a runtime size; only
+	// the gathering is specialized, the scoring is the shared BasicStrengthEvaluator.
+	template<Street S, class Variant = Holdem>
+	class StreetEvaluator {
+	public:
+		static constexpr int board_size = static_cast<int>(S);
+		static_assert(board_size >= 3 && board_size <= 5, "StreetEvaluator needs a flop, turn or river board");
+
+		static StreetStrength evaluate(const SlimHand& hand, const std::array<SlimCard, board_size>& board)
+		{
+			SuitMasks masks = { 0 };
+			add_card(masks, hand.primary);
+			add_card(masks, hand.secondary);
+			add_board(masks, board, std::make_index_sequence<board_size>());
+
+			int strength = BasicStrengthEvaluator<Variant>::evaluate(masks);
+			return { BasicStrengthEvaluator<Variant>::category(strength), strength };
+		}
+
+		// Throws std::invalid_argument unless the board has exactly board_size cards.
+		static StreetStrength evaluate(const PokerHand& hand, const Board& board)
+		{
+			if (board.size() != board_size) {
+				throw std::invalid_argument("Board doesn't match the evaluator's street: " + board.repr());
+			}
+
+			std::array<SlimCard, board_size> cards;
+			for (int i = 0; i < board_size; ++i) cards[i] = to_slim_card(board[i]);
+			return evaluate(SlimHand{ to_slim_card(hand.get_primary()), to_slim_card(hand.get_secondary()) }, cards);
+		}
+
+	private:
+		template<std::size_t... I>
+		static void add_board(SuitMasks& masks, const std::array<SlimCard, board_size>& board, std::index_sequence<I...>)
+		{
+			(add_card(masks, board[I]), ...);
+		}
+	};
+
+	using FlopEvaluator = StreetEvaluator<Street::FLOP>;
+	using TurnEvaluator = StreetEvaluator<Street::TURN>;
+	using RiverEvaluator = StreetEvaluator<Street::RIVER>;
+
+	// Board data that depends only on the rank multiset, shared by every board of that class.
+	// There are 6,175 classes for the full deck; at 14 bytes each the table fits in L2.
+	struct RankClass {
+		std::array<std::pair<char, char>, 5> ranks;
+		// bit r set for every board rank r; straights are found by adding the hole ranks
+		uint16_t rank_mask = 0;
+		char rank_count = 0;
+	};
+
+	// Per-board record: the cards sorted by rank, the board's rank class and its flush suit.
 	struct BoardCache {
 		std::array<SlimCard, 5> board;
-		std::array<std::array<char, 13>, 13> straights;
-		std::vector<std::pair<char, char>> ranks;
-		std::array<char, 4> suits = { 0 };
+		uint16_t rank_class = 0;
 		char max_suit = 0;
 		char suit_count = 0;
 	};
@@ -40,10 +140,11 @@ namespace Poker {
 		std::array<char, 4> suits = { 0 };
 	};
 
-	class CachedEvaluator {
+	template<class Variant>
+	class BasicCachedEvaluator {
 	public:
-		CachedEvaluator(HandCache*& hero_cache, HandCache*& vill_cache, BoardCache*& board_cache)
-			: hero{ hero_cache }, vill{ vill_cache }, board_cache{ board_cache } {}
+		BasicCachedEvaluator(HandCache*& hero_cache, HandCache*& vill_cache, const BoardCache*& board_cache, const RankClass*& rank_classes)
+			: hero{ hero_cache }, vill{ vill_cache }, board_cache{ board_cache }, rank_classes{ rank_classes } {}
 
 		int evaluate();
 
@@ -52,35 +153,24 @@ namespace Poker {
 			Props(HandCache*& cache) : cache{ cache } {}
 
 			HandCache*& cache;
-			std::array<SlimCard, 7> cards;
-			std::array<int, 4> suits;
-			std::array<std::array<char, 5>, 4> matches;
+			// ranks by how often they occur among all seven cards (index 0 for singles), highest first
+			std::array<std::array<char, 7>, 4> matches;
 			std::array<int, 4> match_counts;
-			std::array<char, 5> kickers = { 1 };
 			std::array<char, 3> hand_ranks = { 1 };
-			char straight_rank = 1;
+			// five highest ranks of the flush suit, as a rank bitmask
+			int flush_ranks = 0;
+			char straight_rank = 0;
+			char strf_rank = 0;
 			bool is_flush = false;
 			bool is_straight = false;
-			bool is_royal = false;
-			bool is_strf = false;
 			bool is_full_house = false;
-			int kicker_count = 0;
 		};
 
 		void process_flush(Props& props);
 		void process_straight(Props& props);
-		void process_matches();
-
-		void init_royal_flush(Props& props);
-		void init_straight_flush(Props& props);
-		void init_quads();
-		void init_flush();
-		void init_trips();
-		void init_two_pair();
-		void init_pair();
-		void eval_two_kickers();
-
-		bool check_royal();
+		void process_matches(Props& props);
+		static void add_match(Props& props, char rank, int count);
+
 		bool check_strf();
 		bool check_quads();
 		bool check_full_house();
@@ -91,11 +181,14 @@ namespace Poker {
 		bool check_pair();
 		void check_high_card();
 
-		BoardCache*& board_cache;
+		const BoardCache*& board_cache;
+		const RankClass*& rank_classes;
+		const RankClass* rank_cache = nullptr;
 		Props hero;
 		Props vill;
 
-		std::array<char, 2> min_ranks = { 1 };
 		int result = 0;
 	};
+
+	using CachedEvaluator = BasicCachedEvaluator<Holdem>;
 }
\ No newline at end of file
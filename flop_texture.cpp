@@ -0,0 +1,238 @@
+#include "flop_texture.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+namespace Poker {
+	// utility
+
+	std::string made_hand_name(MadeHand made)
+	{
+		const char* names[] = {
+			"straight flush", "quads", "full house", "flush", "straight", "set", "trips", "two pair",
+			"overpair", "top pair", "underpair", "middle pair", "bottom pair", "ace high", "nothing"
+		};
+		return names[static_cast<int>(made)];
+	}
+
+	std::string draw_name(Draw draw)
+	{
+		const char* names[] = { "flush draw", "backdoor flush draw", "open-ended", "gutshot", "combo draw", "overcards" };
+		return names[static_cast<int>(draw)];
+	}
+
+	inline int rank_bit(int rank)
+	{
+		return 1 << (rank - 2);
+	}
+
+	// Highest straight in a 13-bit rank mask, the ace also playing low, or 0.
+	char find_straight(int ranks)
+	{
+		int extended = (ranks << 1) | (ranks >> 12 & 1);
+		for (int top = 14; top >= 5; --top) {
+			int window = 0x1f << (top - 5);
+			if ((extended & window) == window) return static_cast<char>(top);
+		}
+		return 0;
+	}
+
+	// Some window of five ranks holds every board rank, so two more cards can fill it.
+	bool straight_possible(int ranks, int distinct)
+	{
+		if (distinct < 3) return false;
+
+		int ace_high = ranks << 1;
+		int ace_low = ((ranks & 0xfff) << 1) | (ranks >> 12 & 1);
+		for (int top = 14; top >= 5; --top) {
+			int window = 0x1f << (top - 5);
+			if (!(ace_high & ~window) || !(ace_low & ~window)) return true;
+		}
+		return false;
+	}
+
+
+	// FlopTextureAnalyzer
+
+	struct FlopTextureAnalyzer::Flop {
+		uint64_t mask = 0;
+		int ranks = 0;
+		std::array<char, 15> counts = { 0 };
+		std::array<char, 4> suits = { 0 };
+		// highest and lowest board rank
+		char top = 0;
+		char bottom = 0;
+		bool paired = false;
+		bool trips = false;
+	};
+
+	FlopTextureAnalyzer::FlopTextureAnalyzer(int threads)
+		: threads{ threads > 0 ? threads : std::max(1, static_cast<int>(std::thread::hardware_concurrency())) }
+	{
+		for (int ranks = 0; ranks < (1 << 13); ++ranks) {
+			straight_tops[ranks] = find_straight(ranks);
+
+			char outs = 0;
+			for (int rank = 2; rank <= 14; ++rank) {
+				if (!(ranks & rank_bit(rank)) && find_straight(ranks | rank_bit(rank))) ++outs;
+			}
+			straight_outs[ranks] = outs;
+		}
+	}
+
+	unsigned FlopTextureAnalyzer::texture(const Board& flop)
+	{
+		std::array<int, 4> suits = { 0 };
+		int ranks = 0;
+		for (const Card& card : flop) {
+			++suits[static_cast<int>(card.get_suit())];
+			ranks |= rank_bit(static_cast<int>(card.get_rank()));
+		}
+
+		int distinct = __builtin_popcount(ranks);
+		int max_suit = *std::max_element(suits.begin(), suits.end());
+
+		unsigned texture = max_suit == 3 ? MONOTONE : max_suit == 2 ? TWO_TONE : RAINBOW;
+		if (distinct < flop.size()) texture |= PAIRED;
+		if (straight_possible(ranks, distinct)) texture |= STRAIGHT_POSSIBLE;
+		return texture;
+	}
+
+	void FlopTextureAnalyzer::classify(const Flop& flop, const Combo& combo,
+		std::array<double, made_hand_count>& made, std::array<double, draw_count>& draws) const
+	{
+		bool pocket = combo.high == combo.low;
+		int high_count = flop.counts[combo.high];
+		int low_count = flop.counts[combo.low];
+		int ranks = flop.ranks | rank_bit(combo.high) | rank_bit(combo.low);
+		bool flush = combo.high_suit == combo.low_suit && flop.suits[combo.high_suit] == 3;
+		bool straight = straight_tops[ranks];
+
+		MadeHand hand;
+		if (flush && straight) hand = MadeHand::STRAIGHT_FLUSH;
+		else if (pocket ? high_count == 2 : high_count == 3 || low_count == 3) hand = MadeHand::QUADS;
+		else if (pocket ? (high_count == 1 && flop.paired) || flop.trips : (high_count == 2 && low_count == 1) || (high_count == 1 && low_count == 2)) {
+			hand = MadeHand::FULL_HOUSE;
+		}
+		else if (flush) hand = MadeHand::FLUSH;
+		else if (straight) hand = MadeHand::STRAIGHT;
+		else if (pocket) {
+			if (high_count) hand = MadeHand::SET;
+			else hand = combo.high > flop.top ? MadeHand::OVERPAIR : MadeHand::UNDERPAIR;
+		}
+		else if (high_count == 2 || low_count == 2) hand = MadeHand::TRIPS;
+		else if (high_count && low_count) hand = MadeHand::TWO_PAIR;
+		else if (high_count || low_count) {
+			char rank = high_count ? combo.high : combo.low;
+			hand = rank == flop.top ? MadeHand::TOP_PAIR : rank == flop.bottom ? MadeHand::BOTTOM_PAIR : MadeHand::MIDDLE_PAIR;
+		}
+		else hand = combo.high == 14 ? MadeHand::ACE_HIGH : MadeHand::NOTHING;
+
+		made[static_cast<int>(hand)] += combo.weight;
+		if (static_cast<int>(hand) <= static_cast<int>(MadeHand::STRAIGHT)) return;
+
+		int suited = combo.high_suit == combo.low_suit
+			? flop.suits[combo.high_suit] + 2
+			: std::max(flop.suits[combo.high_suit], flop.suits[combo.low_suit]) + 1;
+		int outs = straight_outs[ranks];
+
+		if (suited == 4) draws[static_cast<int>(Draw::FLUSH_DRAW)] += combo.weight;
+		if (suited == 3) draws[static_cast<int>(Draw::BACKDOOR_FLUSH_DRAW)] += combo.weight;
+		if (outs >= 2) draws[static_cast<int>(Draw::OPEN_ENDED)] += combo.weight;
+		if (outs == 1) draws[static_cast<int>(Draw::GUTSHOT)] += combo.weight;
+		if (suited == 4 && outs) draws[static_cast<int>(Draw::COMBO_DRAW)] += combo.weight;
+		if (hand >= MadeHand::ACE_HIGH && combo.low > flop.top) draws[static_cast<int>(Draw::OVERCARDS)] += combo.weight;
+	}
+
+	TextureReport FlopTextureAnalyzer::analyze(const PokerRange& range, const FlopFilter& filter) const
+	{
+		// duplicate combos are merged, so each is classified once per flop
+		std::vector<double> weights(Holdem::hand_count, range.size() ? 0 : 1);
+		for (int i = 0; i < range.size(); ++i) {
+			weights[hand_to_index(range[i])] += range.weight(i);
+		}
+
+		std::vector<Combo> combos;
+		for (int i = 1; i < Holdem::deck_size; ++i) {
+			for (int j = 0; j < i; ++j) {
+				SlimCard high = index_to_slim_card(i);
+				SlimCard low = index_to_slim_card(j);
+				double weight = weights[hand_to_index(SlimHand{ high, low })];
+				if (weight <= 0) continue;
+
+				combos.push_back({ card_mask(i) | card_mask(j), weight, high.rank, low.rank, high.suit, low.suit });
+			}
+		}
+
+		std::vector<std::array<char, 3>> flops;
+		for (char i = 2; i < Holdem::deck_size; ++i) {
+			for (char j = 1; j < i; ++j) {
+				for (char k = 0; k < j; ++k) flops.push_back({ i, j, k });
+			}
+		}
+
+		TextureReport report;
+		std::mutex mutex;
+		std::atomic<size_t> cursor{ 0 };
+		const size_t chunk = 64;
+
+		auto work = [&] {
+			std::array<double, made_hand_count> made = { 0 };
+			std::array<double, draw_count> draws = { 0 };
+			int flop_count = 0;
+
+			for (size_t begin; (begin = cursor.fetch_add(chunk)) < flops.size();) {
+				for (size_t index = begin; index < std::min(begin + chunk, flops.size()); ++index) {
+					Flop flop;
+					Board board;
+					for (char card : flops[index]) {
+						SlimCard slim = index_to_slim_card(card);
+						flop.mask |= card_mask(card);
+						flop.ranks |= rank_bit(slim.rank);
+						++flop.counts[slim.rank];
+						++flop.suits[slim.suit];
+						board.add_card(bit_to_card(card));
+					}
+
+					unsigned texture = FlopTextureAnalyzer::texture(board);
+					if ((texture & filter.require) != filter.require || (texture & filter.exclude)) continue;
+
+					// cards come in descending order
+					SlimCard first = index_to_slim_card(flops[index][0]);
+					if (filter.high_rank && first.rank != filter.high_rank) continue;
+
+					flop.top = first.rank;
+					flop.bottom = index_to_slim_card(flops[index][2]).rank;
+					flop.paired = texture & PAIRED;
+					flop.trips = flop.top == flop.bottom;
+					++flop_count;
+
+					for (const Combo& combo : combos) {
+						if (combo.mask & flop.mask) continue;
+						classify(flop, combo, made, draws);
+					}
+				}
+			}
+
+			std::lock_guard<std::mutex> lock(mutex);
+			report.flops += flop_count;
+			for (int i = 0; i < made_hand_count; ++i) report.made[i] += made[i];
+			for (int i = 0; i < draw_count; ++i) report.draws[i] += draws[i];
+		};
+
+		std::vector<std::thread> workers;
+		for (int i = 1; i < threads; ++i) workers.emplace_back(work);
+		work();
+		for (auto& worker : workers) worker.join();
+
+		// every pair lands in exactly one made hand category
+		for (double weight : report.made) report.weight += weight;
+		if (report.weight > 0) {
+			for (double& share : report.made) share /= report.weight;
+			for (double& share : report.draws) share /= report.weight;
+		}
+		return report;
+	}
+}
\ No newline at end of file
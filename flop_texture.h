@@ -0,0 +1,97 @@
+#pragma once
+
+#include "equity.h"
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Poker {
+	// Best made hand of a combo on the flop, strongest first. Pairs are named by the hole cards
+	// that make them, so a hand that only plays the board's pair counts as unpaired.
+	enum class MadeHand {
+		STRAIGHT_FLUSH, QUADS, FULL_HOUSE, FLUSH, STRAIGHT, SET, TRIPS, TWO_PAIR,
+		OVERPAIR, TOP_PAIR, UNDERPAIR, MIDDLE_PAIR, BOTTOM_PAIR, ACE_HIGH, NOTHING
+	};
+
+	// Draws are counted independently of each other, only for combos without a straight or better.
+	enum class Draw {
+		// four to a flush using a hole card, and three to one
+		FLUSH_DRAW, BACKDOOR_FLUSH_DRAW,
+		// at least two ranks complete a straight (open-enders and double gutters), and exactly one
+		OPEN_ENDED, GUTSHOT,
+		// a flush draw together with either straight draw
+		COMBO_DRAW,
+		// both hole cards above the board with no pair made
+		OVERCARDS
+	};
+
+	const int made_hand_count = 15;
+	const int draw_count = 6;
+
+	std::string made_hand_name(MadeHand made);
+	std::string draw_name(Draw draw);
+
+	// Board properties a flop filter can require or exclude.
+	enum FlopTexture : unsigned {
+		MONOTONE = 1, TWO_TONE = 2, RAINBOW = 4,
+		// at least two cards of one rank, trips included
+		PAIRED = 8,
+		// some two-card holding makes a straight
+		STRAIGHT_POSSIBLE = 16
+	};
+
+	struct FlopFilter {
+		// every set texture bit must hold, and none of the excluded ones
+		unsigned require = 0;
+		unsigned exclude = 0;
+		// rank of the highest board card, 0 for any
+		int high_rank = 0;
+	};
+
+	// Share of (flop, combo) pairs in each category, weighted by the combo weights; a combo only
+	// counts on flops it doesn't share a card with.
+	struct TextureReport {
+		int flops = 0;
+		double weight = 0;
+		std::array<double, made_hand_count> made = { 0 };
+		std::array<double, draw_count> draws = { 0 };
+
+		double frequency(MadeHand hand) const { return made[static_cast<int>(hand)]; }
+		double frequency(Draw draw) const { return draws[static_cast<int>(draw)]; }
+	};
+
+	// Flopzilla-style hit frequencies of a range over every flop that passes a filter. Flops are
+	// split across threads; each flop's rank counts, suit counts and straight lookups are worked
+	// out once and shared by every combo, which then classifies with a few table lookups.
+	class FlopTextureAnalyzer {
+	public:
+		FlopTextureAnalyzer(int threads = 0);
+
+		// An empty range stands for every combo.
+		TextureReport analyze(const PokerRange& range, const FlopFilter& filter = FlopFilter()) const;
+
+		static unsigned texture(const Board& flop);
+
+	private:
+		struct Combo {
+			uint64_t mask;
+			double weight;
+			char high;
+			char low;
+			char high_suit;
+			char low_suit;
+		};
+
+		struct Flop;
+
+		void classify(const Flop& flop, const Combo& combo, std::array<double, made_hand_count>& made, std::array<double, draw_count>& draws) const;
+
+		int threads;
+		// indexed by a 13-bit rank mask (bit 0 for deuces): top rank of a straight or 0, and the
+		// number of missing ranks that would complete one
+		std::array<char, 1 << 13> straight_tops;
+		std::array<char, 1 << 13> straight_outs;
+	};
+}
\ No newline at end of file
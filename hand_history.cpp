@@ -0,0 +1,451 @@
+#include "hand_history.h"
+#include "equity.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Poker {
+	// utility
+
+	const char hand_marker[] = "PokerStars Hand #";
+	const uint32_t output_magic = 0x43564550;
+	const uint32_t output_version = 1;
+
+	bool starts_with(std::string_view text, std::string_view prefix)
+	{
+		return text.substr(0, prefix.size()) == prefix;
+	}
+
+	// Reads the space-separated cards of the [...] group starting at text[open].
+	int read_cards(std::string_view text, std::string_view::size_type open, Card* cards, int capacity)
+	{
+		if (open == std::string_view::npos) return 0;
+
+		int count = 0;
+		for (auto i = open + 1; i + 1 < text.size() && text[i] != ']'; i += 3) {
+			if (count == capacity) return 0;
+
+			Card card(text.substr(i, 2));
+			if (card.get_rank() == CardRank::PLACEHOLDER || card.get_suit() == CardSuit::PLACEHOLDER) return 0;
+			cards[count++] = card;
+		}
+		return count;
+	}
+
+	bool take(const Card& card, uint64_t& dead)
+	{
+		uint64_t bit = card_mask(card_bit(card));
+		if (dead & bit) return false;
+		dead |= bit;
+		return true;
+	}
+
+
+	// parsing
+
+	bool parse_all_in(std::string_view text, AllInHand& hand)
+	{
+		hand = AllInHand();
+
+		auto id = text.find(hand_marker);
+		if (id == std::string_view::npos) return false;
+		for (id += sizeof(hand_marker) - 1; id < text.size() && text[id] >= '0' && text[id] <= '9'; ++id) {
+			hand.id = hand.id * 10 + (text[id] - '0');
+		}
+
+		// the board is collected in full and cut back to the all-in street at the end
+		Board board;
+		bool all_in = false;
+
+		for (std::string_view::size_type start = 0; start < text.size();) {
+			auto stop = text.find('\n', start);
+			if (stop == std::string_view::npos) stop = text.size();
+			std::string_view line = text.substr(start, stop - start);
+			start = stop + 1;
+
+			if (starts_with(line, "*** SUMMARY ***")) break;
+
+			if (starts_with(line, "*** FLOP ***") || starts_with(line, "*** TURN ***") || starts_with(line, "*** RIVER ***")) {
+				std::array<Card, 3> cards;
+				int count = read_cards(line, line.rfind('['), cards.data(), 3);
+				if (!count || board.size() + count > Board::capacity) return false;
+				for (int i = 0; i < count; ++i) board.add_card(cards[i]);
+			}
+			else if (line.find("is all-in") != std::string_view::npos) {
+				all_in = true;
+				hand.street = board.street();
+			}
+			else if (line.find(": shows [") != std::string_view::npos) {
+				if (hand.player_count == AllInHand::max_players) return false;
+
+				std::array<Card, 2> cards;
+				if (read_cards(line, line.find('[', line.find(": shows [")), cards.data(), 2) != 2) return false;
+				hand.hands[hand.player_count++] = PokerHand(cards[0], cards[1]);
+			}
+		}
+
+		if (!all_in || hand.player_count < 2) return false;
+
+		uint64_t dead = 0;
+		for (int i = 0; i < static_cast<int>(hand.street); ++i) {
+			if (!take(board[i], dead)) return false;
+			hand.board.add_card(board[i]);
+		}
+		for (int i = 0; i < hand.player_count; ++i) {
+			if (!take(hand.hands[i].get_primary(), dead) || !take(hand.hands[i].get_secondary(), dead)) return false;
+		}
+		return true;
+	}
+
+
+	// equity
+
+	void multiway_equity(const AllInHand& hand, double* equities)
+	{
+		SuitMasks board_masks = to_suit_masks(hand.board);
+		uint64_t dead = hand.board.mask();
+
+		std::array<SuitMasks, AllInHand::max_players> holes;
+		for (int i = 0; i < hand.player_count; ++i) {
+			holes[i] = { 0 };
+			add_card(holes[i], to_slim_card(hand.hands[i].get_primary()));
+			add_card(holes[i], to_slim_card(hand.hands[i].get_secondary()));
+			dead |= card_mask(card_bit(hand.hands[i].get_primary())) | card_mask(card_bit(hand.hands[i].get_secondary()));
+		}
+
+		std::fill(equities, equities + hand.player_count, 0.0);
+		uint64_t runouts = 0;
+		int size = hand.board.size();
+
+		auto visit = [&](const std::array<char, 5>& runout) {
+			SuitMasks masks = board_masks;
+			for (int i = size; i < 5; ++i) add_card(masks, index_to_slim_card(runout[i]));
+
+			std::array<int, AllInHand::max_players> strengths;
+			int best = -1;
+			int winners = 0;
+			for (int i = 0; i < hand.player_count; ++i) {
+				SuitMasks seven = masks;
+				for (int suit = 0; suit < 4; ++suit) seven[suit] |= holes[i][suit];
+
+				strengths[i] = StrengthEvaluator::evaluate(seven);
+				if (strengths[i] > best) {
+					best = strengths[i];
+					winners = 1;
+				}
+				else if (strengths[i] == best) {
+					++winners;
+				}
+			}
+
+			for (int i = 0; i < hand.player_count; ++i) {
+				if (strengths[i] == best) equities[i] += 1.0 / winners;
+			}
+			++runouts;
+		};
+
+		std::array<char, 5> runout;
+		for_each_runout(runout, size, 0, dead, visit);
+
+		for (int i = 0; i < hand.player_count; ++i) equities[i] /= runouts;
+	}
+
+
+	// EquityCache
+
+	// All-ins that differ only by a relabelling of suits have the same equities, so the key is
+	// the smallest encoding over all 24 suit permutations. Seat order is kept, which lets a hit
+	// be copied out without remapping.
+	struct AllInKey {
+		std::array<uint64_t, 3> words;
+
+		bool operator==(const AllInKey& other) const { return words == other.words; }
+	};
+
+	struct AllInKeyHash {
+		size_t operator()(const AllInKey& key) const
+		{
+			uint64_t hash = key.words[0] * 0x9e3779b97f4a7c15ull;
+			hash = (hash ^ (hash >> 29) ^ key.words[1]) * 0xbf58476d1ce4e5b9ull;
+			hash = (hash ^ (hash >> 32) ^ key.words[2]) * 0x94d049bb133111ebull;
+			return static_cast<size_t>(hash ^ (hash >> 31));
+		}
+	};
+
+	AllInKey canonical_key(const AllInHand& hand)
+	{
+		std::array<int, 4> suits = { 0, 1, 2, 3 };
+		auto relabel = [&](int bit) { return bit / 4 * 4 + suits[bit % 4]; };
+
+		AllInKey best;
+		bool first = true;
+		do {
+			AllInKey key = { { 0, 0, 0 } };
+			for (const Card& card : hand.board) key.words[0] |= card_mask(relabel(card_bit(card)));
+
+			// 12 bits per hand, five hands per word; an empty slot can't collide since hi > lo
+			for (int i = 0; i < hand.player_count; ++i) {
+				int a = relabel(card_bit(hand.hands[i].get_primary()));
+				int b = relabel(card_bit(hand.hands[i].get_secondary()));
+				uint64_t packed = static_cast<uint64_t>(std::max(a, b) << 6 | std::min(a, b));
+				key.words[1 + i / 5] |= packed << (12 * (i % 5));
+			}
+
+			if (first || key.words < best.words) best = key;
+			first = false;
+		} while (std::next_permutation(suits.begin(), suits.end()));
+
+		return best;
+	}
+
+	// Sharded so workers rarely contend; a full shard is simply cleared, which keeps memory
+	// bounded without bookkeeping on every hit.
+	class EquityCache {
+	public:
+		EquityCache(size_t capacity) : shard_capacity{ std::max<size_t>(capacity / shard_count, 1) } {}
+
+		bool find(const AllInKey& key, double* equities, int count)
+		{
+			Shard& shard = shards[AllInKeyHash()(key) % shard_count];
+			std::lock_guard<std::mutex> lock(shard.mutex);
+
+			auto it = shard.entries.find(key);
+			if (it == shard.entries.end()) return false;
+			std::copy(it->second.begin(), it->second.begin() + count, equities);
+			return true;
+		}
+
+		void insert(const AllInKey& key, const double* equities, int count)
+		{
+			Shard& shard = shards[AllInKeyHash()(key) % shard_count];
+			std::lock_guard<std::mutex> lock(shard.mutex);
+
+			if (shard.entries.size() >= shard_capacity) shard.entries.clear();
+			std::copy(equities, equities + count, shard.entries[key].begin());
+		}
+
+	private:
+		static const int shard_count = 64;
+
+		struct Shard {
+			std::mutex mutex;
+			std::unordered_map<AllInKey, std::array<double, AllInHand::max_players>, AllInKeyHash> entries;
+		};
+
+		std::array<Shard, shard_count> shards;
+		size_t shard_capacity;
+	};
+
+
+	// MappedFile
+
+	class MappedFile {
+	public:
+		MappedFile(const std::string& path)
+		{
+			int fd = open(path.c_str(), O_RDONLY);
+			if (fd < 0) throw std::runtime_error("Can't open hand history: " + path);
+
+			struct stat info;
+			if (fstat(fd, &info) != 0) {
+				close(fd);
+				throw std::runtime_error("Can't read hand history: " + path);
+			}
+
+			size = static_cast<size_t>(info.st_size);
+			if (size) {
+				void* ptr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+				if (ptr == MAP_FAILED) {
+					close(fd);
+					throw std::runtime_error("Can't map hand history: " + path);
+				}
+				data = static_cast<const char*>(ptr);
+				madvise(ptr, size, MADV_SEQUENTIAL);
+			}
+			close(fd);
+		}
+
+		~MappedFile()
+		{
+			if (data) munmap(const_cast<char*>(data), size);
+		}
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		std::string_view text() const { return std::string_view(data, size); }
+
+		// Drops the pages before offset, so resident memory doesn't grow with the file.
+		void release(size_t offset)
+		{
+			size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+			size_t bytes = offset / page * page;
+			if (bytes > released) {
+				madvise(const_cast<char*>(data) + released, bytes - released, MADV_DONTNEED);
+				released = bytes;
+			}
+		}
+
+	private:
+		const char* data = nullptr;
+		size_t size = 0;
+		size_t released = 0;
+	};
+
+
+	// ColumnWriter
+
+	class ColumnWriter {
+	public:
+		ColumnWriter(const std::string& path) : file{ std::fopen(path.c_str(), "wb") }
+		{
+			if (!file) throw std::runtime_error("Can't create output: " + path);
+			std::fwrite(&output_magic, sizeof(output_magic), 1, file);
+			std::fwrite(&output_version, sizeof(output_version), 1, file);
+		}
+
+		// Only a fallback for an error path; close() is what reports a failed final write.
+		~ColumnWriter()
+		{
+			if (file) std::fclose(file);
+		}
+
+		ColumnWriter(const ColumnWriter&) = delete;
+		ColumnWriter& operator=(const ColumnWriter&) = delete;
+
+		void add_row(const AllInHand& hand, const double* equities)
+		{
+			ids.push_back(hand.id);
+			streets.push_back(static_cast<uint8_t>(hand.street));
+			players.push_back(static_cast<uint8_t>(hand.player_count));
+			for (int i = 0; i < hand.player_count; ++i) this->equities.push_back(static_cast<float>(equities[i]));
+		}
+
+		void flush()
+		{
+			if (ids.empty()) return;
+
+			uint32_t rows = static_cast<uint32_t>(ids.size());
+			uint32_t equity_count = static_cast<uint32_t>(equities.size());
+			bool ok = std::fwrite(&rows, sizeof(rows), 1, file) == 1
+				&& std::fwrite(&equity_count, sizeof(equity_count), 1, file) == 1
+				&& std::fwrite(ids.data(), sizeof(uint64_t), rows, file) == rows
+				&& std::fwrite(streets.data(), sizeof(uint8_t), rows, file) == rows
+				&& std::fwrite(players.data(), sizeof(uint8_t), rows, file) == rows
+				&& std::fwrite(equities.data(), sizeof(float), equity_count, file) == equity_count;
+			if (!ok) throw std::runtime_error("Can't write output");
+
+			ids.clear();
+			streets.clear();
+			players.clear();
+			equities.clear();
+		}
+
+		// Writes any pending rows and closes the file; the buffered tail can still fail here.
+		void close()
+		{
+			flush();
+
+			bool ok = !std::ferror(file) && std::fflush(file) == 0;
+			ok = std::fclose(file) == 0 && ok;
+			file = nullptr;
+			if (!ok) throw std::runtime_error("Can't write output");
+		}
+
+	private:
+		FILE* file;
+		std::vector<uint64_t> ids;
+		std::vector<uint8_t> streets;
+		std::vector<uint8_t> players;
+		std::vector<float> equities;
+	};
+
+
+	// processing
+
+	struct AllInResult {
+		bool valid;
+		AllInHand hand;
+		std::array<double, AllInHand::max_players> equities;
+	};
+
+	AllInEvStats process_hand_histories(const std::vector<std::string>& inputs, const std::string& output,
+		const AllInEvOptions& options)
+	{
+		int threads = options.threads > 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+		size_t block_hands = static_cast<size_t>(std::max(options.block_hands, 1));
+
+		AllInEvStats stats;
+		EquityCache cache(options.cache_entries);
+		ColumnWriter writer(output);
+
+		std::vector<std::string_view> texts;
+		std::vector<AllInResult> results(block_hands);
+		std::atomic<uint64_t> cache_hits{ 0 };
+
+		for (const std::string& input : inputs) {
+			MappedFile file(input);
+			std::string_view text = file.text();
+			auto next = text.find(hand_marker);
+
+			while (next != std::string_view::npos) {
+				// cut the next block at hand boundaries; results are written in input order
+				texts.clear();
+				while (next != std::string_view::npos && texts.size() < block_hands) {
+					auto stop = text.find(hand_marker, next + 1);
+					texts.push_back(text.substr(next, stop == std::string_view::npos ? std::string_view::npos : stop - next));
+					next = stop;
+				}
+
+				std::atomic<size_t> cursor{ 0 };
+				auto work = [&] {
+					for (size_t i; (i = cursor++) < texts.size();) {
+						AllInResult& result = results[i];
+						result.valid = parse_all_in(texts[i], result.hand);
+						if (!result.valid) continue;
+
+						AllInKey key = canonical_key(result.hand);
+						if (cache.find(key, result.equities.data(), result.hand.player_count)) {
+							++cache_hits;
+						}
+						else {
+							multiway_equity(result.hand, result.equities.data());
+							cache.insert(key, result.equities.data(), result.hand.player_count);
+						}
+					}
+				};
+
+				std::vector<std::thread> workers;
+				for (int i = 1; i < threads; ++i) workers.emplace_back(work);
+				work();
+				for (auto& worker : workers) worker.join();
+
+				for (size_t i = 0; i < texts.size(); ++i) {
+					if (!results[i].valid) continue;
+					writer.add_row(results[i].hand, results[i].equities.data());
+					++stats.all_ins;
+				}
+				writer.flush();
+
+				stats.hands += texts.size();
+				file.release(next == std::string_view::npos ? text.size() : next);
+			}
+		}
+
+		writer.close();
+
+		stats.cache_hits = cache_hits;
+		return stats;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "poker_game.h"
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Poker {
+	// An all-in that reached showdown: the hands that were shown and the board as it stood
+	// on the street of the last all-in.
+	struct AllInHand {
+		static const int max_players = 10;
+
+		uint64_t id = 0;
+		Street street = Street::PREFLOP;
+		std::array<PokerHand, max_players> hands;
+		int player_count = 0;
+		Board board;
+	};
+
+	// Reads one PokerStars-style hold'em hand. Returns false if nobody went all-in or fewer
+	// than two hands were shown.
+	bool parse_all_in(std::string_view text, AllInHand& hand);
+
+	// Exact multiway equity of each hand over every runout of the board; equities must hold player_count values.
+	void multiway_equity(const AllInHand& hand, double* equities);
+
+	struct AllInEvOptions {
+		int threads = 0;
+		int block_hands = 4096;
+		size_t cache_entries = 1 << 20;
+	};
+
+	struct AllInEvStats {
+		uint64_t hands = 0;
+		uint64_t all_ins = 0;
+		uint64_t cache_hits = 0;
+	};
+
+	// Streams every input file through the parser and equity workers and writes one row per
+	// all-in to a columnar file. Memory stays bounded by the block size and cache capacity.
+	//
+	// Output: "PEVC" magic, uint32 version, then blocks of
+	//   uint32 rows, uint32 equity_count,
+	//   uint64 id[rows], uint8 street[rows], uint8 players[rows], float equity[equity_count]
+	// where each row owns players[i] consecutive equities, in the order the hands were shown.
+	AllInEvStats process_hand_histories(const std::vector<std::string>& inputs, const std::string& output,
+		const AllInEvOptions& options = AllInEvOptions());
+}
\ No newline at end of file
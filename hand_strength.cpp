@@ -0,0 +1,156 @@
+#include "hand_strength.h"
+
+#include <stdexcept>
+
+namespace Poker {
+	// utility
+
+	// hero's standing against one combo
+	const int ahead = 0;
+	const int tied = 1;
+	const int behind = 2;
+
+	inline int standing(int hero, int vill)
+	{
+		return hero > vill ? ahead : hero < vill ? behind : tied;
+	}
+
+	inline int strength_with(const SuitMasks& board, const SuitMasks& hole)
+	{
+		SuitMasks masks = { static_cast<uint16_t>(board[0] | hole[0]), static_cast<uint16_t>(board[1] | hole[1]),
+			static_cast<uint16_t>(board[2] | hole[2]), static_cast<uint16_t>(board[3] | hole[3]) };
+		return StrengthEvaluator::evaluate(masks);
+	}
+
+
+	// HandStrengthSolver
+
+	void HandStrengthSolver::add_combo(const Card& card1, const Card& card2, double weight, uint64_t dead, int hero_strength, const SuitMasks& board_masks)
+	{
+		uint64_t mask = card_mask(card_bit(card1)) | card_mask(card_bit(card2));
+		if (mask & dead || card_bit(card1) == card_bit(card2) || weight <= 0) return;
+
+		Combo combo;
+		combo.masks = { 0 };
+		add_card(combo.masks, to_slim_card(card1));
+		add_card(combo.masks, to_slim_card(card2));
+		combo.mask = mask;
+		combo.weight = weight;
+		combo.current = standing(hero_strength, strength_with(board_masks, combo.masks));
+		combo.high = to_slim_card(card1.get_rank() < card2.get_rank() ? card2 : card1);
+		combo.low = to_slim_card(card1.get_rank() < card2.get_rank() ? card1 : card2);
+		combos.push_back(combo);
+	}
+
+	int HandStrengthSolver::river_strength(const Combo& combo, const SuitMasks& masks, int flush_suit, int flush_need)
+	{
+		if (flush_suit >= 0 && (combo.high.suit == flush_suit) + (combo.low.suit == flush_suit) >= flush_need) {
+			return strength_with(masks, combo.masks);
+		}
+
+		Memo& memo = rank_strengths[combo.high.rank][combo.low.rank];
+		if (memo.stamp != stamp) {
+			memo.stamp = stamp;
+			memo.strength = strength_with(masks, combo.masks);
+		}
+		return memo.strength;
+	}
+
+	HandPotential HandStrengthSolver::evaluate(const PokerHand& hand, const Board& board, const PokerRange& vill)
+	{
+		if (board.size() < 3) throw std::invalid_argument("Hand potential needs a flop: " + board.repr());
+
+		SuitMasks board_masks = to_suit_masks(board);
+		SuitMasks hero_masks = { 0 };
+		add_card(hero_masks, to_slim_card(hand.get_primary()));
+		add_card(hero_masks, to_slim_card(hand.get_secondary()));
+		uint64_t dead = board.mask() | card_mask(card_bit(hand.get_primary())) | card_mask(card_bit(hand.get_secondary()));
+		int hero_now = strength_with(board_masks, hero_masks);
+
+		combos.clear();
+		if (vill.size()) {
+			for (int i = 0; i < vill.size(); ++i) {
+				add_combo(vill[i].get_primary(), vill[i].get_secondary(), vill.weight(i), dead, hero_now, board_masks);
+			}
+		}
+		else {
+			for (int i = 1; i < Holdem::deck_size; ++i) {
+				for (int j = 0; j < i; ++j) {
+					SlimCard high = index_to_slim_card(i);
+					SlimCard low = index_to_slim_card(j);
+					add_combo(Card(static_cast<CardRank>(high.rank), static_cast<CardSuit>(high.suit)),
+						Card(static_cast<CardRank>(low.rank), static_cast<CardSuit>(low.suit)), 1.0, dead, hero_now, board_masks);
+				}
+			}
+		}
+
+		HandPotential result;
+		double now[3] = { 0 };
+		for (const Combo& combo : combos) now[combo.current] += combo.weight;
+		double now_total = now[ahead] + now[tied] + now[behind];
+		if (now_total <= 0) return result;
+		result.hs = (now[ahead] + now[tied] / 2) / now_total;
+
+		// potential[now][river], weighted by combo and summed over runouts
+		double potential[3][3] = { { 0 } };
+		double ehs2_sum = 0;
+		int runouts = 0;
+
+		auto visit = [&](const std::array<char, 5>& runout) {
+			SuitMasks masks = board_masks;
+			uint64_t runout_mask = 0;
+			for (int i = board.size(); i < 5; ++i) {
+				add_card(masks, index_to_slim_card(runout[i]));
+				runout_mask |= card_mask(runout[i]);
+			}
+			int hero_river = strength_with(masks, hero_masks);
+
+			// at most one suit has three or more of the five board cards
+			int flush_suit = -1;
+			int flush_need = 0;
+			for (int suit = 0; suit < 4; ++suit) {
+				int count = __builtin_popcount(masks[suit]);
+				if (count >= 3) {
+					flush_suit = suit;
+					flush_need = 5 - count;
+				}
+			}
+			++stamp;
+
+			double river[3] = { 0 };
+			for (const Combo& combo : combos) {
+				if (combo.mask & runout_mask) continue;
+
+				int later = standing(hero_river, river_strength(combo, masks, flush_suit, flush_need));
+				potential[combo.current][later] += combo.weight;
+				river[later] += combo.weight;
+			}
+
+			double river_total = river[ahead] + river[tied] + river[behind];
+			if (river_total > 0) {
+				double strength = (river[ahead] + river[tied] / 2) / river_total;
+				ehs2_sum += strength * strength;
+				++runouts;
+			}
+		};
+
+		std::array<char, 5> runout;
+		for_each_runout(runout, board.size(), 0, dead, visit);
+
+		double totals[3];
+		for (int i = 0; i < 3; ++i) totals[i] = potential[i][ahead] + potential[i][tied] + potential[i][behind];
+
+		double ppot_base = totals[behind] + totals[tied] / 2;
+		double npot_base = totals[ahead] + totals[tied] / 2;
+		if (ppot_base > 0) {
+			result.ppot = (potential[behind][ahead] + potential[behind][tied] / 2 + potential[tied][ahead] / 2) / ppot_base;
+		}
+		if (npot_base > 0) {
+			result.npot = (potential[ahead][behind] + potential[ahead][tied] / 2 + potential[tied][behind] / 2) / npot_base;
+		}
+
+		result.ehs = result.hs * (1 - result.npot) + (1 - result.hs) * result.ppot;
+		result.ehs2 = runouts ? ehs2_sum / runouts : 0;
+		return result;
+	}
+}
\ No newline at end of file
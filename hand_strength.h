@@ -0,0 +1,56 @@
+#pragma once
+
+#include "equity.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace Poker {
+	// Billings-style strength of a hand against a villain range, all as probabilities.
+	struct HandPotential {
+		// share of villain combos beaten now, ties counted half
+		double hs = 0;
+		// chance to get ahead from behind (or tied), and to fall behind from ahead (or tied), by the river
+		double ppot = 0;
+		double npot = 0;
+		// hs * (1 - npot) + (1 - hs) * ppot
+		double ehs = 0;
+		// mean over runouts of the squared river hand strength
+		double ehs2 = 0;
+	};
+
+	// Computes every HandPotential field in one pass over the runouts. Each runout's villain
+	// strengths are evaluated once and feed both the potential matrix and the river strength.
+	// Scratch buffers are kept between calls, so one solver per thread is cheapest.
+	class HandStrengthSolver {
+	public:
+		// board must hold 3 to 5 cards; an empty range stands for every combo.
+		HandPotential evaluate(const PokerHand& hand, const Board& board, const PokerRange& vill = PokerRange());
+
+	private:
+		struct Combo {
+			SuitMasks masks;
+			uint64_t mask;
+			double weight;
+			int current;
+			SlimCard high;
+			SlimCard low;
+		};
+
+		struct Memo {
+			uint64_t stamp = 0;
+			int strength = 0;
+		};
+
+		int river_strength(const Combo& combo, const SuitMasks& masks, int flush_suit, int flush_need);
+
+		void add_combo(const Card& card1, const Card& card2, double weight, uint64_t dead, int hero_strength, const SuitMasks& board_masks);
+
+		std::vector<Combo> combos;
+		// strengths of combos that can't make a flush only depend on their ranks, so each
+		// runout scores at most one combo per rank pair
+		std::array<std::array<Memo, 15>, 15> rank_strengths;
+		uint64_t stamp = 0;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,198 @@
+#include "hi_lo.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace Poker {
+	// utility
+
+	// Five lowest ranks of a mask, or 0 with fewer than five.
+	int lowest_five(int ranks)
+	{
+		if (__builtin_popcount(ranks) < 5) return 0;
+		while (__builtin_popcount(ranks) > 5) ranks &= ~(1 << (31 - __builtin_clz(ranks)));
+		return ranks;
+	}
+
+	inline int low_strength(int five)
+	{
+		return five ? 256 - five : 0;
+	}
+
+	struct LowTables {
+		LowTables()
+		{
+			for (int ranks = 0; ranks < 256; ++ranks) {
+				any_five[ranks] = static_cast<uint16_t>(low_strength(lowest_five(ranks)));
+			}
+
+			// every pair of hole ranks, completed by the three lowest board ranks not already held
+			for (int hole = 0; hole < 256; ++hole) {
+				for (int board = 0; board < 256; ++board) {
+					int best = 0;
+					for (int first = 0; first < 8; ++first) {
+						for (int second = first + 1; second < 8; ++second) {
+							int pair = (1 << first) | (1 << second);
+							if ((hole & pair) != pair) continue;
+
+							int rest = board & ~pair;
+							if (__builtin_popcount(rest) < 3) continue;
+							while (__builtin_popcount(rest) > 3) rest &= ~(1 << (31 - __builtin_clz(rest)));
+							best = std::max(best, low_strength(pair | rest));
+						}
+					}
+					two_plus_three[hole][board] = static_cast<uint16_t>(best);
+				}
+			}
+		}
+
+		std::array<uint16_t, 256> any_five;
+		std::array<std::array<uint16_t, 256>, 256> two_plus_three;
+	};
+
+	const LowTables& low_tables()
+	{
+		static const LowTables tables;
+		return tables;
+	}
+
+
+	// LowEvaluator
+
+	int LowEvaluator::rank_bits(const SlimCard* cards, int size)
+	{
+		int ranks = 0;
+		for (int i = 0; i < size; ++i) {
+			if (cards[i].rank == 14) ranks |= 1;
+			else if (cards[i].rank <= 8) ranks |= 1 << (cards[i].rank - 1);
+		}
+		return ranks;
+	}
+
+	int LowEvaluator::evaluate(int ranks)
+	{
+		return low_tables().any_five[ranks];
+	}
+
+	int LowEvaluator::evaluate_omaha(int hole, int board)
+	{
+		return low_tables().two_plus_three[hole][board];
+	}
+
+
+	// HiLoEquitySolver
+
+	int HiLoEquitySolver::take(const Card& card)
+	{
+		int index = card_to_index(card);
+		if (dead & card_mask(index)) {
+			throw std::invalid_argument("Card dealt twice: " + card.repr());
+		}
+		dead |= card_mask(index);
+		return index;
+	}
+
+	std::vector<HiLoEquity> HiLoEquitySolver::enumerate(const std::vector<PokerHand>& hands, const Board& board)
+	{
+		dead = 0;
+		players.resize(hands.size());
+		sizes.assign(hands.size(), 0);
+		for (size_t i = 0; i < hands.size(); ++i) {
+			players[i][sizes[i]++] = index_to_slim_card(take(hands[i].get_primary()));
+			players[i][sizes[i]++] = index_to_slim_card(take(hands[i].get_secondary()));
+		}
+		return enumerate(board);
+	}
+
+	std::vector<HiLoEquity> HiLoEquitySolver::enumerate(const std::vector<OmahaHand>& hands, const Board& board)
+	{
+		dead = 0;
+		players.resize(hands.size());
+		sizes.assign(hands.size(), 0);
+		for (size_t i = 0; i < hands.size(); ++i) {
+			for (const Card& card : hands[i]) players[i][sizes[i]++] = index_to_slim_card(take(card));
+		}
+		return enumerate(board);
+	}
+
+	std::vector<HiLoEquity> HiLoEquitySolver::enumerate(const Board& board)
+	{
+		highs.resize(players.size());
+		lows.resize(players.size());
+		equities.assign(players.size(), HiLoEquity());
+		count = 0;
+
+		board_size = 0;
+		for (const Card& card : board) {
+			runout[board_size++] = take(card);
+		}
+
+		auto visit = [this](const std::array<char, 5>& cards) { add_runout(cards); };
+		for_each_runout(runout, board_size, 0, dead, visit);
+
+		for (HiLoEquity& equity : equities) {
+			equity.high /= count;
+			equity.low /= count;
+			equity.scoop /= count;
+			equity.equity = equity.high + equity.low;
+		}
+		return equities;
+	}
+
+	void HiLoEquitySolver::add_runout(const std::array<char, 5>& cards)
+	{
+		std::array<SlimCard, 5> board;
+		SuitMasks board_masks = { 0 };
+		for (int i = 0; i < 5; ++i) {
+			board[i] = index_to_slim_card(cards[i]);
+			add_card(board_masks, board[i]);
+		}
+		int board_low = LowEvaluator::rank_bits(board.data(), 5);
+		bool omaha_set = false;
+
+		int best_high = 0;
+		int best_low = 0;
+		for (size_t i = 0; i < players.size(); ++i) {
+			const SlimCard* hand = players[i].data();
+			int hole_low = LowEvaluator::rank_bits(hand, sizes[i]);
+
+			if (sizes[i] == 2) {
+				SuitMasks masks = board_masks;
+				add_card(masks, hand[0]);
+				add_card(masks, hand[1]);
+				highs[i] = StrengthEvaluator::evaluate(masks);
+				lows[i] = LowEvaluator::evaluate(hole_low | board_low);
+			}
+			else {
+				if (!omaha_set) {
+					omaha.set_board(board);
+					omaha_set = true;
+				}
+				highs[i] = omaha.evaluate(hand, sizes[i]);
+				lows[i] = LowEvaluator::evaluate_omaha(hole_low, board_low);
+			}
+
+			best_high = std::max(best_high, highs[i]);
+			best_low = std::max(best_low, lows[i]);
+		}
+
+		int high_winners = 0;
+		int low_winners = 0;
+		for (size_t i = 0; i < players.size(); ++i) {
+			high_winners += highs[i] == best_high;
+			low_winners += best_low && lows[i] == best_low;
+		}
+
+		// without a qualifying low the high hand takes the whole pot
+		double high_half = best_low ? 0.5 : 1.0;
+		for (size_t i = 0; i < players.size(); ++i) {
+			bool high = highs[i] == best_high;
+			bool low = best_low && lows[i] == best_low;
+
+			if (high) equities[i].high += high_half / high_winners;
+			if (low) equities[i].low += 0.5 / low_winners;
+			if (high && high_winners == 1 && (!best_low || (low && low_winners == 1))) equities[i].scoop += 1;
+		}
+		++count;
+	}
+}
\ No newline at end of file
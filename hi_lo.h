@@ -0,0 +1,60 @@
+#pragma once
+
+#include "omaha.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace Poker {
+	// Eight-or-better lows, ace to five: aces play low and straights and flushes don't count, so a
+	// low is a set of five distinct ranks from ace to eight. Sets are kept as 8-bit rank masks (bit 0
+	// for the ace, bit r - 1 for rank r up to the eight), where the lower mask is the better low,
+	// since the comparison runs from the highest card down. Strengths are 256 minus the mask, so
+	// higher is better like the high evaluators, and 0 means no qualifying low.
+	class LowEvaluator {
+	public:
+		static int rank_bits(const SlimCard* cards, int size);
+
+		// Best low from any five of the cards in ranks.
+		static int evaluate(int ranks);
+		// Best low from exactly two of the hole ranks and three of the board ranks.
+		static int evaluate_omaha(int hole, int board);
+	};
+
+	struct HiLoEquity {
+		// expected share of the pot, the sum of the two halves below
+		double equity = 0;
+		// expected share won with the high hand; the whole pot when nobody qualifies for low
+		double high = 0;
+		double low = 0;
+		// chance of taking the whole pot
+		double scoop = 0;
+	};
+
+	// Exact hi/lo split-pot equities. Each runout scores every player's high and low in the same
+	// pass; the high half is split among the tied high hands and the low half among the tied lows,
+	// which quarters the pot when two players tie for one half. Two card hands play hold'em rules
+	// (any five of seven), four and five card hands Omaha rules (exactly two from the hand).
+	class HiLoEquitySolver {
+	public:
+		std::vector<HiLoEquity> enumerate(const std::vector<PokerHand>& hands, const Board& board = Board());
+		std::vector<HiLoEquity> enumerate(const std::vector<OmahaHand>& hands, const Board& board = Board());
+
+	private:
+		int take(const Card& card);
+		std::vector<HiLoEquity> enumerate(const Board& board);
+		void add_runout(const std::array<char, 5>& runout);
+
+		OmahaEvaluator omaha;
+		std::vector<std::array<SlimCard, 5>> players;
+		std::vector<int> sizes;
+		std::vector<int> highs;
+		std::vector<int> lows;
+		std::vector<HiLoEquity> equities;
+		std::array<char, 5> runout;
+		int board_size = 0;
+		uint64_t dead = 0;
+		int count = 0;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,202 @@
+#include "lookup_evaluator.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+namespace Poker {
+	// utility
+
+	const uint32_t table_magic = 0x50455654;
+	// bumped whenever the state layout changes, so an older file is regenerated
+	const uint32_t table_version = 1;
+	// ints generate() produces: 53 transitions for each of the 612,977 states plus the unused state 0
+	const uint64_t table_size = 32487834;
+
+	// Packs a card set into one byte per card (rank << 4 | suit, both 1-based), sorted
+	// descending. Suits that can no longer reach five cards are cleared to 0, which folds
+	// every suit-irrelevant set onto one state. Returns 0 for a duplicate or fifth card of a rank.
+	int64_t make_id(int64_t id, int card, int& count)
+	{
+		std::array<int, 8> cards = { 0 };
+		std::array<int, 5> suits = { 0 };
+		std::array<int, 14> ranks = { 0 };
+
+		for (int i = 0; i < 6; ++i) {
+			cards[i + 1] = static_cast<int>((id >> (8 * i)) & 0xff);
+		}
+
+		--card;
+		cards[0] = (((card >> 2) + 1) << 4) + (card & 3) + 1;
+
+		for (count = 0; count < 7 && cards[count]; ++count) {
+			++suits[cards[count] & 0xf];
+			++ranks[(cards[count] >> 4) & 0xf];
+			if (count && cards[0] == cards[count]) return 0;
+		}
+
+		for (int rank = 1; rank < 14; ++rank) {
+			if (ranks[rank] > 4) return 0;
+		}
+
+		int needed = count - 2;
+		if (needed > 1) {
+			for (int i = 0; i < count; ++i) {
+				if (suits[cards[i] & 0xf] < needed) cards[i] &= 0xf0;
+			}
+		}
+
+		// unused slots are 0 and every card is positive, so sorting the whole array keeps them
+		// last and gives the compiler a constant bound
+		std::sort(cards.begin(), cards.end(), std::greater<int>());
+
+		int64_t result = 0;
+		for (int i = 0; i < count; ++i) {
+			result += static_cast<int64_t>(cards[i]) << (8 * i);
+		}
+		return result;
+	}
+
+	int evaluate_id(int64_t id)
+	{
+		SuitMasks masks = { 0 };
+		std::array<int, 4> counts = { 0 };
+		std::array<int, 7> loose;
+		int loose_count = 0;
+
+		for (int i = 0; i < 7; ++i) {
+			int card = static_cast<int>((id >> (8 * i)) & 0xff);
+			if (!card) break;
+
+			int rank = (card >> 4) + 1;
+			int suit = card & 0xf;
+			if (suit) {
+				masks[suit - 1] |= 1 << rank;
+				++counts[suit - 1];
+			}
+			else {
+				loose[loose_count++] = rank;
+			}
+		}
+
+		// cards without a suit go to the emptiest suit that lacks their rank, which never builds a flush
+		for (int i = 0; i < loose_count; ++i) {
+			int best = -1;
+			for (int suit = 0; suit < 4; ++suit) {
+				if (masks[suit] & (1 << loose[i]) || counts[suit] >= 5) continue;
+				if (best < 0 || counts[suit] < counts[best]) best = suit;
+			}
+			masks[best] |= 1 << loose[i];
+			++counts[best];
+		}
+
+		return StrengthEvaluator::evaluate(masks);
+	}
+
+
+	// LookupTable
+
+	std::shared_ptr<const LookupTable> LookupTable::load_or_generate(const std::string& path)
+	{
+		std::shared_ptr<LookupTable> table(new LookupTable());
+		if (!table->load(path)) {
+			table->generate();
+			table->save(path);
+		}
+		return table;
+	}
+
+	int LookupTable::evaluate(const SlimCard* cards, int count) const
+	{
+		int state = start();
+		for (int i = 0; i < count; ++i) {
+			state = next(state, cards[i]);
+		}
+		return count == 7 ? state : value(state);
+	}
+
+	bool LookupTable::load(const std::string& path)
+	{
+		FILE* file = std::fopen(path.c_str(), "rb");
+		if (!file) return false;
+
+		uint32_t magic = 0;
+		uint32_t version = 0;
+		uint64_t size = 0;
+		bool ok = std::fread(&magic, sizeof(magic), 1, file) == 1 && magic == table_magic
+			&& std::fread(&version, sizeof(version), 1, file) == 1 && version == table_version
+			&& std::fread(&size, sizeof(size), 1, file) == 1 && size == table_size;
+
+		if (ok) {
+			table.resize(size);
+			ok = std::fread(table.data(), sizeof(int), size, file) == size;
+		}
+
+		std::fclose(file);
+		if (!ok) table.clear();
+		return ok;
+	}
+
+	void LookupTable::save(const std::string& path) const
+	{
+		// a missing or read-only cache location only costs the next run a regeneration
+		FILE* file = std::fopen(path.c_str(), "wb");
+		if (!file) return;
+
+		uint64_t size = table.size();
+		std::fwrite(&table_magic, sizeof(table_magic), 1, file);
+		std::fwrite(&table_version, sizeof(table_version), 1, file);
+		std::fwrite(&size, sizeof(size), 1, file);
+		std::fwrite(table.data(), sizeof(int), size, file);
+		std::fclose(file);
+	}
+
+	void LookupTable::generate()
+	{
+		// states are built level by level; an id with more cards is always numerically larger,
+		// so the concatenated levels stay sorted for the binary search below
+		std::vector<int64_t> ids = { 0 };
+		std::vector<int64_t> level = { 0 };
+		int count;
+
+		for (int cards = 1; cards < 7; ++cards) {
+			std::vector<int64_t> next_level;
+			for (int64_t id : level) {
+				for (int card = 1; card <= 52; ++card) {
+					int64_t next_id = make_id(id, card, count);
+					if (next_id) next_level.push_back(next_id);
+				}
+			}
+
+			std::sort(next_level.begin(), next_level.end());
+			next_level.erase(std::unique(next_level.begin(), next_level.end()), next_level.end());
+			ids.insert(ids.end(), next_level.begin(), next_level.end());
+			level.swap(next_level);
+		}
+
+		table.assign((ids.size() + 1) * 53, 0);
+
+		for (size_t i = 0; i < ids.size(); ++i) {
+			int state = static_cast<int>(i) * 53 + 53;
+
+			int cards = 0;
+			while (cards < 7 && ((ids[i] >> (8 * cards)) & 0xff)) ++cards;
+			if (cards >= 5) table[state] = evaluate_id(ids[i]);
+
+			for (int card = 1; card <= 52; ++card) {
+				int64_t next_id = make_id(ids[i], card, count);
+				if (!next_id) continue;
+
+				if (count == 7) {
+					table[state + card] = evaluate_id(next_id);
+				}
+				else {
+					size_t index = std::lower_bound(ids.begin(), ids.end(), next_id) - ids.begin();
+					table[state + card] = static_cast<int>(index) * 53 + 53;
+				}
+			}
+		}
+	}
+}
\ No newline at end of file
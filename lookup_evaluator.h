@@ -0,0 +1,65 @@
+#pragma once
+
+#include "evaluator.h"
+#include "table_allocator.h"
+
+#include <memory>
+#include <string>
+
+namespace Poker {
+	enum class EvaluatorEngine {
+		CACHED, LOOKUP
+	};
+
+	// Card-by-card transition table in the style of the 7-card lookup DAG: every state is a
+	// set of up to 6 cards (with suits dropped once they can no longer make a flush), and
+	// each card costs one load. The 7th card's transition holds the final strength.
+	class LookupTable {
+	public:
+		static constexpr const char* default_path = "hand_ranks.dat";
+
+		// Reads the table from path, or generates it and writes it there for the next run.
+		static std::shared_ptr<const LookupTable> load_or_generate(const std::string& path = default_path);
+
+		int start() const { return 53; }
+		int next(int state, const SlimCard& card) const { return table[state + (card.rank - 2) * 4 + card.suit + 1]; }
+		// Strength of a completed 5 or 6 card state.
+		int value(int state) const { return table[state]; }
+
+		int evaluate(const SlimCard* cards, int count) const;
+
+	private:
+		LookupTable() {}
+
+		bool load(const std::string& path);
+		void save(const std::string& path) const;
+		void generate();
+
+		Table<int> table;
+	};
+
+	// Same interface as CachedEvaluator, so the solver can swap engines without touching its loop.
+	class LookupEvaluator {
+	public:
+		LookupEvaluator(HandCache*& hero_cache, HandCache*& vill_cache, const BoardCache*& board_cache, const LookupTable*& table)
+			: hero{ hero_cache }, vill{ vill_cache }, board_cache{ board_cache }, table{ table } {}
+
+		int evaluate()
+		{
+			int state = table->start();
+			for (auto& card : board_cache->board) {
+				state = table->next(state, card);
+			}
+
+			int hero_value = table->next(table->next(state, hero->hand.primary), hero->hand.secondary);
+			int vill_value = table->next(table->next(state, vill->hand.primary), vill->hand.secondary);
+			return hero_value - vill_value;
+		}
+
+	private:
+		HandCache*& hero;
+		HandCache*& vill;
+		const BoardCache*& board_cache;
+		const LookupTable*& table;
+	};
+}
\ No newline at end of file
@@ -1,12 +1,441 @@
+#include "differential.h"
 #include "equity.h"
+#include "flop_texture.h"
+#include "hand_history.h"
+#include "hi_lo.h"
+#include "perf_counters.h"
+#include "push_fold.h"
+#include "run_it.h"
+#include "shard.h"
+
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <iomanip>
 #include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+using Clock = std::chrono::steady_clock;
 
-int main() {
+double elapsed_ms(Clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+void benchmark(const char* name, Poker::EvaluatorEngine engine, int queries)
+{
+	Clock::time_point start = Clock::now();
+	Poker::CachedEquitySolver solver(false, Poker::TableOptions(), engine);
+	double setup = elapsed_ms(start);
+
+	double equity = 0;
+	start = Clock::now();
+	for (int i = 0; i < queries; ++i) {
+		equity = solver.enumerate(Poker::PokerHand("Ac5c"), Poker::PokerHand("Td8h"));
+	}
+	double query = elapsed_ms(start) / queries;
+
+	std::cout << name << ": setup " << setup << " ms, " << query << " ms/query, equity " << equity << std::endl;
+}
+
+void benchmark_anytime(std::chrono::microseconds budget)
+{
 	Poker::CachedEquitySolver solver(false);
 
-	for (int i = 0; i < 100; ++i) {
-		std::cout << "Equity: " << solver.enumerate(Poker::PokerHand("Ac5c"), Poker::PokerHand("Td8h")) << std::endl;
+	Clock::time_point start = Clock::now();
+	Poker::AnytimeEquity result = solver.enumerate(Poker::PokerHand("Ac5c"), Poker::PokerHand("Td8h"), Poker::Board(), budget);
+	double query = elapsed_ms(start);
+
+	std::cout << "anytime " << budget.count() << " us: " << query << " ms, equity " << result.equity << " +- " << result.error
+		<< ", coverage " << result.coverage << std::endl;
+}
+
+void benchmark_live(int queries)
+{
+	Poker::LiveEquitySolver solver;
+	Poker::Board board("Kd7h9s4c");
+
+	double equity = 0;
+	Clock::time_point start = Clock::now();
+	for (int i = 0; i < queries; ++i) {
+		equity = solver.enumerate(Poker::PokerHand("Ac5c"), Poker::PokerHand("Td8h"), board);
+	}
+	double query = elapsed_ms(start) * 1000 / queries;
+
+	std::cout << "live turn: " << query << " us/query, equity " << equity << std::endl;
+}
+
+// perf [queries]
+// Hardware counters for building each engine's tables and for a batch of preflop queries.
+int perf(int argc, char** argv)
+{
+	int queries = argc > 2 ? std::stoi(argv[2]) : 20;
+
+	Poker::PerfCounters counters;
+	if (!counters.available()) {
+		std::cout << "hardware counters unavailable (" << counters.status() << "), reporting wall time only" << std::endl;
+	}
+
+	const std::pair<const char*, Poker::EvaluatorEngine> engines[] = {
+		{ "cached", Poker::EvaluatorEngine::CACHED },
+		{ "lookup", Poker::EvaluatorEngine::LOOKUP }
+	};
+	for (const auto& engine : engines) {
+		counters.start();
+		Poker::CachedEquitySolver solver(false, Poker::TableOptions(), engine.second);
+		Poker::PerfSample setup = counters.stop();
+		std::cout << engine.first << " setup: " << setup.report() << std::endl;
+
+		counters.start();
+		for (int i = 0; i < queries; ++i) {
+			solver.enumerate(Poker::PokerHand("Ac5c"), Poker::PokerHand("Td8h"));
+		}
+		Poker::PerfSample query = counters.stop();
+		std::cout << engine.first << " queries: " << query.report(static_cast<double>(solver.board_count()) * queries, "board") << std::endl;
+	}
+	return 0;
+}
+
+// flop-texture <range|all> [texture]...
+// Textures are monotone, two-tone, rainbow, paired and straight, each negated by a "no-" prefix,
+// plus <rank>-high such as A-high.
+int flop_texture(int argc, char** argv)
+{
+	if (argc < 3) {
+		std::cerr << "usage: " << argv[0] << " flop-texture <range|all> [texture]..." << std::endl;
+		return 1;
+	}
+
+	const std::pair<const char*, unsigned> textures[] = {
+		{ "monotone", Poker::MONOTONE }, { "two-tone", Poker::TWO_TONE }, { "rainbow", Poker::RAINBOW },
+		{ "paired", Poker::PAIRED }, { "straight", Poker::STRAIGHT_POSSIBLE }
+	};
+
+	try {
+		Poker::PokerRange range = std::string(argv[2]) == "all" ? Poker::PokerRange() : Poker::PokerRange(argv[2]);
+
+		Poker::FlopFilter filter;
+		for (int i = 3; i < argc; ++i) {
+			std::string word = argv[i];
+			bool exclude = word.compare(0, 3, "no-") == 0;
+			if (exclude) word = word.substr(3);
+
+			if (word.size() == 6 && word.compare(1, 5, "-high") == 0 && Poker::repr_to_rank(word[0]) != Poker::CardRank::PLACEHOLDER) {
+				filter.high_rank = static_cast<int>(Poker::repr_to_rank(word[0]));
+				continue;
+			}
+
+			unsigned texture = 0;
+			for (const auto& entry : textures) {
+				if (word == entry.first) texture = entry.second;
+			}
+			if (!texture) throw std::invalid_argument("Invalid flop texture: " + word);
+			(exclude ? filter.exclude : filter.require) |= texture;
+		}
+
+		Poker::FlopTextureAnalyzer analyzer;
+		Clock::time_point start = Clock::now();
+		Poker::TextureReport report = analyzer.analyze(range, filter);
+		std::cout << report.flops << " flops in " << elapsed_ms(start) << " ms" << std::endl;
+
+		std::cout << std::fixed << std::setprecision(2);
+		for (int i = 0; i < Poker::made_hand_count; ++i) {
+			std::cout << std::setw(22) << Poker::made_hand_name(static_cast<Poker::MadeHand>(i)) << std::setw(8) << report.made[i] * 100 << " %" << std::endl;
+		}
+		std::cout << std::endl;
+		for (int i = 0; i < Poker::draw_count; ++i) {
+			std::cout << std::setw(22) << Poker::draw_name(static_cast<Poker::Draw>(i)) << std::setw(8) << report.draws[i] * 100 << " %" << std::endl;
+		}
+	}
+	catch (const std::exception& e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
+
+// run-it <hero> <vill> <runs> [board]
+int run_it(int argc, char** argv)
+{
+	if (argc < 5) {
+		std::cerr << "usage: " << argv[0] << " run-it <hero> <vill> <runs> [board]" << std::endl;
+		return 1;
+	}
+
+	try {
+		Poker::RunItSolver solver;
+		Clock::time_point start = Clock::now();
+		Poker::RunItDistribution result = solver.enumerate(Poker::PokerHand(argv[2]), Poker::PokerHand(argv[3]),
+			argc > 5 ? Poker::Board(argv[5]) : Poker::Board(), std::stoi(argv[4]));
+		std::cout << "equity " << result.equity << ", deviation " << std::sqrt(result.variance) << " in " << elapsed_ms(start) << " ms" << std::endl;
+		std::cout << "scoop " << result.scoop() << ", split " << result.split() << ", lose " << result.lose() << std::endl;
+		for (size_t i = 0; i < result.shares.size(); ++i) {
+			std::cout << "  share " << i << "/" << 2 * result.runs << ": " << result.shares[i] << std::endl;
+		}
+	}
+	catch (const std::exception& e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
+
+// hi-lo <board|-> <hand>...
+// Two card hands play hold'em, four and five card hands Omaha; all hands must be the same game.
+int hi_lo(int argc, char** argv)
+{
+	if (argc < 5) {
+		std::cerr << "usage: " << argv[0] << " hi-lo <board|-> <hand>..." << std::endl;
+		return 1;
+	}
+
+	try {
+		Poker::Board board = std::string(argv[2]) == "-" ? Poker::Board() : Poker::Board(argv[2]);
+		Poker::HiLoEquitySolver solver;
+		std::vector<Poker::HiLoEquity> equities;
+
+		Clock::time_point start = Clock::now();
+		if (std::string(argv[3]).size() == 4) {
+			std::vector<Poker::PokerHand> hands;
+			for (int i = 3; i < argc; ++i) hands.emplace_back(argv[i]);
+			equities = solver.enumerate(hands, board);
+		}
+		else {
+			std::vector<Poker::OmahaHand> hands;
+			for (int i = 3; i < argc; ++i) hands.emplace_back(argv[i]);
+			equities = solver.enumerate(hands, board);
+		}
+		std::cout << elapsed_ms(start) << " ms" << std::endl;
+
+		for (size_t i = 0; i < equities.size(); ++i) {
+			const Poker::HiLoEquity& equity = equities[i];
+			std::cout << argv[i + 3] << ": equity " << equity.equity << " (high " << equity.high << ", low " << equity.low
+				<< "), scoop " << equity.scoop << std::endl;
+		}
 	}
+	catch (const std::exception& e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
+
+// allin-ev <output> <history>...
+int all_in_ev(int argc, char** argv)
+{
+	if (argc < 4) {
+		std::cerr << "usage: " << argv[0] << " allin-ev <output> <history>..." << std::endl;
+		return 1;
+	}
+
+	std::vector<std::string> inputs(argv + 3, argv + argc);
+	Clock::time_point start = Clock::now();
+	try {
+		Poker::AllInEvStats stats = Poker::process_hand_histories(inputs, argv[2]);
+		std::cout << stats.hands << " hands, " << stats.all_ins << " all-ins, " << stats.cache_hits << " cache hits in "
+			<< elapsed_ms(start) << " ms" << std::endl;
+	}
+	catch (const std::exception& e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
+
+Poker::EvaluatorEngine parse_engine(const std::string& name)
+{
+	if (name == "cached") return Poker::EvaluatorEngine::CACHED;
+	if (name == "lookup") return Poker::EvaluatorEngine::LOOKUP;
+	throw std::invalid_argument("Unknown engine: " + name);
+}
+
+int run_worker(const std::string& socket_path, Poker::EvaluatorEngine engine)
+{
+	try {
+		Poker::run_shard_worker(socket_path, 30000, engine);
+	}
+	catch (const std::exception& e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
+
+// shard-worker <socket> [cached|lookup]
+int shard_worker(int argc, char** argv)
+{
+	if (argc < 3) {
+		std::cerr << "usage: " << argv[0] << " shard-worker <socket> [cached|lookup]" << std::endl;
+		return 1;
+	}
+
+	try {
+		return run_worker(argv[2], argc > 3 ? parse_engine(argv[3]) : Poker::EvaluatorEngine::CACHED);
+	}
+	catch (const std::exception& e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+}
+
+// shard-run <socket> <workers> <hero> <vill> [board|-] [cached|lookup]
+// Forks the workers locally; more can join from other processes with shard-worker.
+int shard_run(int argc, char** argv)
+{
+	if (argc < 6) {
+		std::cerr << "usage: " << argv[0] << " shard-run <socket> <workers> <hero> <vill> [board|-] [cached|lookup]" << std::endl;
+		return 1;
+	}
+
+	std::vector<pid_t> children;
+	try {
+		Poker::Board board = argc > 6 && std::string(argv[6]) != "-" ? Poker::Board(argv[6]) : Poker::Board();
+		Poker::EvaluatorEngine engine = argc > 7 ? parse_engine(argv[7]) : Poker::EvaluatorEngine::CACHED;
+		Poker::ShardCoordinator coordinator(argv[2]);
+
+		for (int i = std::stoi(argv[3]); i > 0; --i) {
+			pid_t pid = fork();
+			if (pid == 0) _exit(run_worker(argv[2], engine));
+			if (pid > 0) children.push_back(pid);
+		}
+
+		Clock::time_point start = Clock::now();
+		Poker::ShardCounts counts = coordinator.enumerate(Poker::PokerHand(argv[4]), Poker::PokerHand(argv[5]), board);
+		std::cout << counts.wins << " wins, " << counts.ties << " ties, " << counts.losses << " losses, equity "
+			<< counts.equity() << ", " << coordinator.reassigned() << " shards reassigned in " << elapsed_ms(start) << " ms" << std::endl;
+	}
+	catch (const std::exception& e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+
+	// the coordinator closed its sockets on the way out, which tells the workers to stop
+	for (pid_t pid : children) waitpid(pid, nullptr, 0);
+	return 0;
+}
+
+// push-fold [max stack]
+// Prints the deepest stack (in big blinds) at which each class shoves and calls.
+int push_fold(int argc, char** argv)
+{
+	double max_stack = argc > 2 ? std::stod(argv[2]) : 20;
+	std::vector<double> stacks;
+	for (double stack = 1; stack <= max_stack; stack += 0.5) stacks.push_back(stack);
+
+	Clock::time_point start = Clock::now();
+	Poker::PushFoldSolver solver;
+	double setup = elapsed_ms(start);
+	start = Clock::now();
+	std::vector<Poker::PushFoldChart> charts = solver.solve(stacks);
+	std::cout << "equities " << setup << " ms, solve " << elapsed_ms(start) << " ms, exploitability at "
+		<< charts.back().stack << " bb " << charts.back().exploitability << " bb/hand" << std::endl;
+
+	for (int side = 0; side < 2; ++side) {
+		std::cout << std::endl << (side ? "call" : "push") << std::endl;
+		for (int row = 12; row >= 0; --row) {
+			for (int column = 12; column >= 0; --column) {
+				int index = row * 13 + column;
+				double deepest = 0;
+				for (const Poker::PushFoldChart& chart : charts) {
+					if ((side ? chart.call[index] : chart.push[index]) >= 0.5) deepest = chart.stack;
+				}
+				std::cout << std::setw(6);
+				if (deepest) std::cout << deepest;
+				else std::cout << "-";
+			}
+			std::cout << std::endl;
+		}
+	}
+	return 0;
+}
+
+template<class Variant>
+uint64_t run_differential(const std::vector<std::pair<const char*, Poker::ShowdownFactory>>& engines, int pairs, uint64_t deals)
+{
+	uint64_t mismatches = 0;
+	for (auto& engine : engines) {
+		Poker::DifferentialRunner<Variant> runner(engine.second);
+		Poker::DifferentialReport reports[] = { runner.exhaustive(pairs), runner.random(deals) };
+		const char* modes[] = { "exhaustive", "random" };
+
+		for (int i = 0; i < 2; ++i) {
+			const Poker::DifferentialReport& report = reports[i];
+			std::cout << engine.first << " " << modes[i] << ": " << report.comparisons << " showdowns, " << report.mismatches
+				<< " mismatches, " << report.engine_rate / 1e6 << " M/s (reference " << report.reference_rate / 1e6 << " M/s)" << std::endl;
+			for (const std::string& repro : report.repros) std::cout << "  " << repro << std::endl;
+			mismatches += report.mismatches;
+		}
+	}
+	return mismatches;
+}
+
+template<class Variant>
+Poker::ShowdownFactory table_engine(std::shared_ptr<Poker::BasicCachedEquitySolver<Variant>> prototype)
+{
+	return [prototype] {
+		auto solver = std::make_shared<Poker::BasicCachedEquitySolver<Variant>>(*prototype);
+		return Poker::Showdown([solver](const Poker::PokerHand& hero, const Poker::PokerHand& vill, const Poker::Board& board) {
+			return solver->showdown(hero, vill, board);
+		});
+	};
+}
+
+template<class Variant>
+Poker::ShowdownFactory strength_engine()
+{
+	return [] {
+		return Poker::Showdown([](const Poker::PokerHand& hero, const Poker::PokerHand& vill, const Poker::Board& board) {
+			using River = Poker::StreetEvaluator<Poker::Street::RIVER, Variant>;
+			return River::evaluate(hero, board).strength - River::evaluate(vill, board).strength;
+		});
+	};
+}
+
+// validate [pairs] [deals]
+// Checks every engine of both variants against the reference evaluator; exits non-zero on any mismatch.
+int validate(int argc, char** argv)
+{
+	int pairs = argc > 2 ? std::stoi(argv[2]) : 4;
+	uint64_t deals = argc > 3 ? std::stoull(argv[3]) : 1000000;
+
+	auto cached = std::make_shared<Poker::CachedEquitySolver>(false);
+	auto lookup = std::make_shared<Poker::CachedEquitySolver>(false, Poker::TableOptions(), Poker::EvaluatorEngine::LOOKUP);
+	uint64_t mismatches = run_differential<Poker::Holdem>({
+		{ "cached", table_engine(cached) },
+		{ "lookup", table_engine(lookup) },
+		{ "strength", strength_engine<Poker::Holdem>() }
+	}, pairs, deals);
+
+	auto short_deck = std::make_shared<Poker::ShortDeckEquitySolver>(false);
+	mismatches += run_differential<Poker::ShortDeck>({
+		{ "short-deck cached", table_engine(short_deck) },
+		{ "short-deck strength", strength_engine<Poker::ShortDeck>() }
+	}, pairs, deals);
+
+	return mismatches ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+	if (argc > 1 && std::string(argv[1]) == "allin-ev") return all_in_ev(argc, argv);
+	if (argc > 1 && std::string(argv[1]) == "shard-worker") return shard_worker(argc, argv);
+	if (argc > 1 && std::string(argv[1]) == "shard-run") return shard_run(argc, argv);
+	if (argc > 1 && std::string(argv[1]) == "push-fold") return push_fold(argc, argv);
+	if (argc > 1 && std::string(argv[1]) == "validate") return validate(argc, argv);
+	if (argc > 1 && std::string(argv[1]) == "perf") return perf(argc, argv);
+	if (argc > 1 && std::string(argv[1]) == "flop-texture") return flop_texture(argc, argv);
+	if (argc > 1 && std::string(argv[1]) == "run-it") return run_it(argc, argv);
+	if (argc > 1 && std::string(argv[1]) == "hi-lo") return hi_lo(argc, argv);
+
+	benchmark("cached", Poker::EvaluatorEngine::CACHED, 20);
+	benchmark("lookup", Poker::EvaluatorEngine::LOOKUP, 20);
+	benchmark_live(100000);
+	benchmark_anytime(std::chrono::microseconds(2000));
 
 	return 0;
 }
\ No newline at end of file
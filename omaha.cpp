@@ -0,0 +1,206 @@
+#include "omaha.h"
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+
+namespace Poker {
+	// utility
+
+	int rank_only_strength(const std::array<char, 5>& ranks)
+	{
+		// spreads the cards over the suits so no five of them can ever form a flush
+		SuitMasks masks = { 0 };
+		for (int i = 0; i < 5; ++i) {
+			int suit = i % 4;
+			while (masks[suit] & (1 << ranks[i])) suit = (suit + 1) % 4;
+			masks[suit] |= 1 << ranks[i];
+		}
+
+		return StrengthEvaluator::evaluate(masks);
+	}
+
+
+	// OmahaEvaluator
+
+	void OmahaEvaluator::set_board(const std::array<SlimCard, 5>& board)
+	{
+		++stamp;
+
+		std::array<char, 4> suits = { 0 };
+		for (auto& card : board) ++suits[card.suit];
+
+		cache.flush_suit = -1;
+		cache.flush_count = 0;
+		for (char i = 0; i < 4; ++i) {
+			if (suits[i] >= 3) cache.flush_suit = i;
+		}
+
+		cache.triple_count = 0;
+		for (int i = 0; i < 5; ++i) {
+			if (board[i].suit == cache.flush_suit) cache.flush_ranks[cache.flush_count++] = board[i].rank;
+
+			for (int j = i + 1; j < 5; ++j) {
+				for (int k = j + 1; k < 5; ++k) {
+					std::array<char, 3> triple = { board[i].rank, board[j].rank, board[k].rank };
+					std::sort(triple.begin(), triple.end());
+
+					auto end = cache.rank_triples.begin() + cache.triple_count;
+					if (std::find(cache.rank_triples.begin(), end, triple) == end) {
+						cache.rank_triples[cache.triple_count++] = triple;
+					}
+				}
+			}
+		}
+	}
+
+	int OmahaEvaluator::rank_strength(char rank1, char rank2)
+	{
+		OmahaBoardCache::Memo& memo = cache.rank_strengths[rank1][rank2];
+		if (memo.stamp == stamp) return memo.strength;
+
+		int best = 0;
+		for (int i = 0; i < cache.triple_count; ++i) {
+			auto& triple = cache.rank_triples[i];
+			best = std::max(best, rank_only_strength({ rank1, rank2, triple[0], triple[1], triple[2] }));
+		}
+
+		memo = { stamp, best };
+		cache.rank_strengths[rank2][rank1] = memo;
+		return best;
+	}
+
+	int OmahaEvaluator::flush_strength(char rank1, char rank2)
+	{
+		OmahaBoardCache::Memo& memo = cache.flush_strengths[rank1][rank2];
+		if (memo.stamp == stamp) return memo.strength;
+
+		int best = 0;
+		for (int i = 0; i < cache.flush_count; ++i) {
+			for (int j = i + 1; j < cache.flush_count; ++j) {
+				for (int k = j + 1; k < cache.flush_count; ++k) {
+					SuitMasks masks = { 0 };
+					masks[0] = (1 << rank1) | (1 << rank2)
+						| (1 << cache.flush_ranks[i]) | (1 << cache.flush_ranks[j]) | (1 << cache.flush_ranks[k]);
+					best = std::max(best, StrengthEvaluator::evaluate(masks));
+				}
+			}
+		}
+
+		memo = { stamp, best };
+		cache.flush_strengths[rank2][rank1] = memo;
+		return best;
+	}
+
+	int OmahaEvaluator::evaluate(const SlimCard* hand, int size)
+	{
+		int best = 0;
+		for (int i = 0; i < size; ++i) {
+			for (int j = i + 1; j < size; ++j) {
+				best = std::max(best, rank_strength(hand[i].rank, hand[j].rank));
+
+				if (hand[i].suit == cache.flush_suit && hand[j].suit == cache.flush_suit) {
+					best = std::max(best, flush_strength(hand[i].rank, hand[j].rank));
+				}
+			}
+		}
+
+		return best;
+	}
+
+
+	// OmahaEquitySolver
+
+	void OmahaEquitySolver::prepare(const std::vector<OmahaHand>& hands, const Board& board)
+	{
+		players.resize(hands.size());
+		sizes.resize(hands.size());
+		strengths.resize(hands.size());
+		equities.assign(hands.size(), 0);
+		count = 0;
+		dead = 0;
+		board_size = 0;
+
+		auto take = [&](const Card& card) {
+			int index = card_to_index(card);
+			if (dead & card_mask(index)) {
+				throw std::invalid_argument("Card dealt twice: " + card.repr());
+			}
+			dead |= card_mask(index);
+			return index;
+		};
+
+		for (size_t i = 0; i < hands.size(); ++i) {
+			sizes[i] = hands[i].size();
+			for (int j = 0; j < sizes[i]; ++j) {
+				players[i][j] = index_to_slim_card(take(hands[i][j]));
+			}
+		}
+
+		for (const Card& card : board) {
+			runout[board_size++] = take(card);
+		}
+	}
+
+	void OmahaEquitySolver::add_runout(const std::array<char, 5>& cards)
+	{
+		std::array<SlimCard, 5> board;
+		for (int i = 0; i < 5; ++i) board[i] = index_to_slim_card(cards[i]);
+		evaluator.set_board(board);
+
+		int best = 0;
+		int winners = 0;
+		for (size_t i = 0; i < players.size(); ++i) {
+			strengths[i] = evaluator.evaluate(players[i].data(), sizes[i]);
+			if (strengths[i] > best) {
+				best = strengths[i];
+				winners = 1;
+			}
+			else if (strengths[i] == best) {
+				++winners;
+			}
+		}
+
+		for (size_t i = 0; i < players.size(); ++i) {
+			if (strengths[i] == best) equities[i] += 1.0 / winners;
+		}
+		++count;
+	}
+
+	std::vector<double> OmahaEquitySolver::enumerate(const std::vector<OmahaHand>& hands, const Board& board)
+	{
+		prepare(hands, board);
+
+		auto visit = [this](const std::array<char, 5>& cards) { add_runout(cards); };
+		for_each_runout(runout, board_size, 0, dead, visit);
+
+		for (double& equity : equities) equity /= count;
+		return equities;
+	}
+
+	std::vector<double> OmahaEquitySolver::sample(const std::vector<OmahaHand>& hands, const Board& board, int trials, uint64_t seed)
+	{
+		if (trials < 1) throw std::invalid_argument("Sampling needs at least one trial");
+		prepare(hands, board);
+
+		std::vector<char> deck;
+		for (char i = 0; i < 52; ++i) {
+			if (!(dead & card_mask(i))) deck.push_back(i);
+		}
+
+		std::mt19937_64 rng(seed);
+		std::array<char, 5> cards = runout;
+		for (int trial = 0; trial < trials; ++trial) {
+			// partial Fisher-Yates: the first missing board cards are a uniform draw without replacement
+			for (int i = board_size; i < 5; ++i) {
+				std::uniform_int_distribution<size_t> pick(i - board_size, deck.size() - 1);
+				std::swap(deck[i - board_size], deck[pick(rng)]);
+				cards[i] = deck[i - board_size];
+			}
+			add_runout(cards);
+		}
+
+		for (double& equity : equities) equity /= count;
+		return equities;
+	}
+}
\ No newline at end of file
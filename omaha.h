@@ -0,0 +1,61 @@
+#pragma once
+
+#include "equity.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace Poker {
+	// Board-side data shared by every Omaha hand on one runout. Hole card pairs are scored
+	// lazily per rank pair (and per rank pair of the flush suit), so each player only pays
+	// a lookup per pair instead of ten 5-card evaluations.
+	struct OmahaBoardCache {
+		struct Memo {
+			uint64_t stamp = 0;
+			int strength = 0;
+		};
+
+		std::array<std::array<char, 3>, 10> rank_triples;
+		std::array<char, 5> flush_ranks;
+		std::array<std::array<Memo, 15>, 15> rank_strengths;
+		std::array<std::array<Memo, 15>, 15> flush_strengths;
+		char triple_count = 0;
+		char flush_count = 0;
+		char flush_suit = -1;
+	};
+
+	class OmahaEvaluator {
+	public:
+		void set_board(const std::array<SlimCard, 5>& board);
+		// Best strength using exactly two of the 4 or 5 hole cards and three board cards.
+		int evaluate(const SlimCard* hand, int size);
+
+	private:
+		int rank_strength(char rank1, char rank2);
+		int flush_strength(char rank1, char rank2);
+
+		OmahaBoardCache cache;
+		uint64_t stamp = 0;
+	};
+
+	class OmahaEquitySolver {
+	public:
+		std::vector<double> enumerate(const std::vector<OmahaHand>& hands, const Board& board = Board());
+		std::vector<double> sample(const std::vector<OmahaHand>& hands, const Board& board, int trials, uint64_t seed = 0);
+
+	private:
+		void prepare(const std::vector<OmahaHand>& hands, const Board& board);
+		void add_runout(const std::array<char, 5>& runout);
+
+		OmahaEvaluator evaluator;
+		std::vector<std::array<SlimCard, 5>> players;
+		std::vector<int> sizes;
+		std::vector<int> strengths;
+		std::vector<double> equities;
+		std::array<char, 5> runout;
+		int board_size = 0;
+		uint64_t dead = 0;
+		int count = 0;
+	};
+}
\ No newline at end of file
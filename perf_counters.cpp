@@ -0,0 +1,188 @@
+#include "perf_counters.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <sstream>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Poker {
+	// utility
+
+	const char* perf_event_name(PerfEvent event)
+	{
+		switch (event) {
+		case PerfEvent::CYCLES: return "cycles";
+		case PerfEvent::INSTRUCTIONS: return "instructions";
+		case PerfEvent::BRANCH_MISSES: return "branch-misses";
+		case PerfEvent::CACHE_MISSES: return "cache-misses";
+		case PerfEvent::DTLB_MISSES: return "dTLB-misses";
+		}
+		return "unknown";
+	}
+
+	double now_seconds()
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+#ifdef __linux__
+	int open_perf_event(PerfEvent event)
+	{
+		perf_event_attr attr;
+		std::memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.disabled = 1;
+		attr.inherit = 1;
+		// user space only, which an unprivileged process may count at perf_event_paranoid <= 2
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+		switch (event) {
+		case PerfEvent::CYCLES:
+			attr.type = PERF_TYPE_HARDWARE;
+			attr.config = PERF_COUNT_HW_CPU_CYCLES;
+			break;
+		case PerfEvent::INSTRUCTIONS:
+			attr.type = PERF_TYPE_HARDWARE;
+			attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+			break;
+		case PerfEvent::BRANCH_MISSES:
+			attr.type = PERF_TYPE_HARDWARE;
+			attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+			break;
+		case PerfEvent::CACHE_MISSES:
+			// last level cache misses
+			attr.type = PERF_TYPE_HARDWARE;
+			attr.config = PERF_COUNT_HW_CACHE_MISSES;
+			break;
+		case PerfEvent::DTLB_MISSES:
+			attr.type = PERF_TYPE_HW_CACHE;
+			attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+			break;
+		}
+
+		return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+	}
+
+	// value, time enabled, time running
+	bool read_perf_event(int fd, uint64_t* values)
+	{
+		return read(fd, values, 3 * sizeof(uint64_t)) == 3 * sizeof(uint64_t);
+	}
+#endif
+
+
+	// PerfSample
+
+	double PerfSample::ipc() const
+	{
+		if (!has(PerfEvent::CYCLES) || !has(PerfEvent::INSTRUCTIONS) || !get(PerfEvent::CYCLES)) return 0;
+		return static_cast<double>(get(PerfEvent::INSTRUCTIONS)) / get(PerfEvent::CYCLES);
+	}
+
+	double PerfSample::per(PerfEvent event, double units) const
+	{
+		if (!has(event) || units <= 0) return 0;
+		return get(event) / units;
+	}
+
+	std::string PerfSample::report(double units, const std::string& unit) const
+	{
+		std::ostringstream out;
+		out << seconds * 1000 << " ms";
+		if (ipc()) out << ", ipc " << ipc();
+
+		for (int i = 0; i < perf_event_count; ++i) {
+			if (!available[i]) continue;
+
+			PerfEvent event = static_cast<PerfEvent>(i);
+			if (units > 0) out << ", " << per(event, units) << " " << perf_event_name(event) << "/" << unit;
+			else out << ", " << values[i] << " " << perf_event_name(event);
+		}
+		return out.str();
+	}
+
+
+	// PerfCounters
+
+	PerfCounters::PerfCounters()
+	{
+		fds.fill(-1);
+
+#ifdef __linux__
+		for (int i = 0; i < perf_event_count; ++i) {
+			fds[i] = open_perf_event(static_cast<PerfEvent>(i));
+			if (fds[i] < 0 && error.empty()) {
+				error = std::string("perf_event_open: ") + std::strerror(errno);
+			}
+		}
+#else
+		error = "hardware counters need Linux perf_event_open";
+#endif
+	}
+
+	PerfCounters::~PerfCounters()
+	{
+#ifdef __linux__
+		for (int fd : fds) {
+			if (fd >= 0) close(fd);
+		}
+#endif
+	}
+
+	bool PerfCounters::available() const
+	{
+		for (int fd : fds) {
+			if (fd >= 0) return true;
+		}
+		return false;
+	}
+
+	void PerfCounters::start()
+	{
+#ifdef __linux__
+		// counters keep running between regions, so a region is the difference of two reads
+		for (int i = 0; i < perf_event_count; ++i) {
+			if (fds[i] < 0) continue;
+
+			ioctl(fds[i], PERF_EVENT_IOC_ENABLE, 0);
+			if (!read_perf_event(fds[i], &starts[3 * i])) {
+				close(fds[i]);
+				fds[i] = -1;
+			}
+		}
+#endif
+		start_seconds = now_seconds();
+	}
+
+	PerfSample PerfCounters::stop()
+	{
+		PerfSample sample;
+		sample.seconds = now_seconds() - start_seconds;
+
+#ifdef __linux__
+		for (int i = 0; i < perf_event_count; ++i) {
+			uint64_t values[3];
+			if (fds[i] < 0 || !read_perf_event(fds[i], values)) continue;
+
+			uint64_t count = values[0] - starts[3 * i];
+			uint64_t enabled = values[1] - starts[3 * i + 1];
+			uint64_t running = values[2] - starts[3 * i + 2];
+			// a counter that never got scheduled in says nothing about the region
+			if (!running) continue;
+
+			sample.values[i] = running < enabled ? static_cast<uint64_t>(static_cast<double>(count) * enabled / running) : count;
+			sample.available[i] = true;
+		}
+#endif
+		return sample;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+namespace Poker {
+	enum class PerfEvent {
+		CYCLES, INSTRUCTIONS, BRANCH_MISSES, CACHE_MISSES, DTLB_MISSES
+	};
+
+	const int perf_event_count = 5;
+
+	const char* perf_event_name(PerfEvent event);
+
+	// Counter deltas over one measured region. Values are scaled up when the kernel had to
+	// multiplex a counter, and counters that could not be opened are left unavailable.
+	struct PerfSample {
+		std::array<uint64_t, perf_event_count> values = { 0 };
+		std::array<bool, perf_event_count> available = { false };
+		double seconds = 0;
+
+		bool has(PerfEvent event) const { return available[static_cast<int>(event)]; }
+		uint64_t get(PerfEvent event) const { return values[static_cast<int>(event)]; }
+
+		// Instructions per cycle, or 0 if either counter is missing.
+		double ipc() const;
+		// Count per unit of work (boards, queries), or 0 if the counter is missing.
+		double per(PerfEvent event, double units) const;
+		// "12.3 ms, ipc 1.85, 41.2 cycles/board, ..." with missing counters left out.
+		std::string report(double units = 0, const std::string& unit = "") const;
+	};
+
+	// Hardware counters for the calling process via perf_event_open. Each event is opened on its
+	// own and inherited by threads started after construction, so a multithreaded table build is
+	// counted in full. Nothing here throws: without counter access (containers, a strict
+	// perf_event_paranoid, other platforms) samples only carry the wall time.
+	class PerfCounters {
+	public:
+		PerfCounters();
+		~PerfCounters();
+
+		PerfCounters(const PerfCounters&) = delete;
+		PerfCounters& operator=(const PerfCounters&) = delete;
+
+		bool available() const;
+		// Why counters are missing, empty if all of them opened.
+		const std::string& status() const { return error; }
+
+		void start();
+		PerfSample stop();
+
+	private:
+		std::array<int, perf_event_count> fds;
+		std::array<uint64_t, perf_event_count * 3> starts = { 0 };
+		double start_seconds = 0;
+		std::string error;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,138 @@
+#include "poker_eval.h"
+#include "equity.h"
+
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+using Poker::Board;
+using Poker::Card;
+using Poker::CardRank;
+using Poker::CardSuit;
+using Poker::CachedEquitySolver;
+using Poker::PokerHand;
+
+// Solver copies share the board tables but not their per-query state, so each concurrent
+// batch leases its own copy. Copies are created on first demand and then reused.
+struct PokerEvalSolver {
+	struct Worker {
+		Worker(const CachedEquitySolver& prototype) : solver{ prototype } {}
+
+		CachedEquitySolver solver;
+		Board board;
+	};
+
+	PokerEvalSolver(Poker::EvaluatorEngine engine) : prototype{ false, Poker::TableOptions(), engine } {}
+
+	std::unique_ptr<Worker> acquire()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (!idle.empty()) {
+				std::unique_ptr<Worker> worker = std::move(idle.back());
+				idle.pop_back();
+				return worker;
+			}
+		}
+		return std::unique_ptr<Worker>(new Worker(prototype));
+	}
+
+	void release(std::unique_ptr<Worker> worker)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		idle.push_back(std::move(worker));
+	}
+
+	CachedEquitySolver prototype;
+	std::mutex mutex;
+	std::vector<std::unique_ptr<Worker>> idle;
+};
+
+namespace {
+	Card to_card(uint8_t index)
+	{
+		return Card(static_cast<CardRank>(index / 4 + 2), static_cast<CardSuit>(index % 4));
+	}
+
+	PokerHand to_hand(uint8_t card1, uint8_t card2)
+	{
+		return PokerHand(to_card(card1), to_card(card2));
+	}
+
+	bool take(uint8_t index, uint64_t& dead)
+	{
+		if (index >= 52 || dead & Poker::card_mask(index)) return false;
+		dead |= Poker::card_mask(index);
+		return true;
+	}
+}
+
+extern "C" {
+	PokerEvalSolver* poker_eval_solver_create(int engine)
+	{
+		if (engine != POKER_EVAL_ENGINE_CACHED && engine != POKER_EVAL_ENGINE_LOOKUP) return nullptr;
+
+		try {
+			return new PokerEvalSolver(engine == POKER_EVAL_ENGINE_LOOKUP ? Poker::EvaluatorEngine::LOOKUP : Poker::EvaluatorEngine::CACHED);
+		}
+		catch (...) {
+			return nullptr;
+		}
+	}
+
+	void poker_eval_solver_destroy(PokerEvalSolver* solver)
+	{
+		delete solver;
+	}
+
+	int poker_eval_equity_batch(PokerEvalSolver* solver, const uint8_t* hero, const uint8_t* vill,
+		const uint8_t* boards, size_t count, double* equities)
+	{
+		if (!solver || (count && (!hero || !vill || !equities))) return POKER_EVAL_INVALID_ARGUMENT;
+
+		try {
+			std::unique_ptr<PokerEvalSolver::Worker> worker = solver->acquire();
+			int status = POKER_EVAL_OK;
+
+			for (size_t i = 0; i < count; ++i) {
+				uint64_t dead = 0;
+				if (!take(hero[2 * i], dead) || !take(hero[2 * i + 1], dead)
+					|| !take(vill[2 * i], dead) || !take(vill[2 * i + 1], dead))
+				{
+					status = POKER_EVAL_INVALID_CARD;
+					break;
+				}
+
+				worker->board.clear();
+				for (int j = 0; boards && j < 5; ++j) {
+					uint8_t card = boards[5 * i + j];
+					if (card == POKER_EVAL_NO_CARD) continue;
+					// a card after the padding would otherwise be dropped silently
+					if (j > worker->board.size()) {
+						status = POKER_EVAL_INVALID_ARGUMENT;
+						break;
+					}
+					if (!take(card, dead)) {
+						status = POKER_EVAL_INVALID_CARD;
+						break;
+					}
+					worker->board.add_card(to_card(card));
+				}
+				if (status != POKER_EVAL_OK) break;
+
+				equities[i] = worker->solver.enumerate(to_hand(hero[2 * i], hero[2 * i + 1]),
+					to_hand(vill[2 * i], vill[2 * i + 1]), worker->board);
+			}
+
+			solver->release(std::move(worker));
+			return status;
+		}
+		catch (const std::bad_alloc&) {
+			return POKER_EVAL_OUT_OF_MEMORY;
+		}
+		catch (...) {
+			return POKER_EVAL_INTERNAL_ERROR;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+#pragma once
+
+/*
+ * Plain C interface for calling the equity solver from other languages.
+ *
+ * Cards are packed indices, (rank - 2) * 4 + suit with ranks 2..14 and suits c, d, h, s = 0..3.
+ * The batch entry point reads caller-owned arrays and writes into a caller-owned buffer; it
+ * neither copies the inputs nor allocates once a calling thread has warmed up its solver.
+ * A solver handle may be shared by any number of threads.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(_WIN32)
+#define POKER_EVAL_API __declspec(dllexport)
+#else
+#define POKER_EVAL_API __attribute__((visibility("default")))
+#endif
+
+#define POKER_EVAL_NO_CARD 0xFF
+
+typedef struct PokerEvalSolver PokerEvalSolver;
+
+enum PokerEvalStatus {
+	POKER_EVAL_OK = 0,
+	POKER_EVAL_INVALID_ARGUMENT = -1,
+	POKER_EVAL_INVALID_CARD = -2,
+	POKER_EVAL_OUT_OF_MEMORY = -3,
+	POKER_EVAL_INTERNAL_ERROR = -4
+};
+
+enum PokerEvalEngine {
+	POKER_EVAL_ENGINE_CACHED = 0,
+	POKER_EVAL_ENGINE_LOOKUP = 1
+};
+
+/* Builds the board tables; returns NULL on failure. Expensive, create once per process. */
+POKER_EVAL_API PokerEvalSolver* poker_eval_solver_create(int engine);
+
+/* No batch may be running on the handle. */
+POKER_EVAL_API void poker_eval_solver_destroy(PokerEvalSolver* solver);
+
+/*
+ * Heads-up hero equity for count matchups.
+ * hero, vill: 2 * count card indices.
+ * boards:     5 * count card indices padded with POKER_EVAL_NO_CARD, or NULL for preflop.
+ *             Padding must follow the cards; a card after it is an invalid argument.
+ * equities:   count doubles, written in order.
+ * Stops at the first malformed matchup and returns its status.
+ */
+POKER_EVAL_API int poker_eval_equity_batch(PokerEvalSolver* solver, const uint8_t* hero, const uint8_t* vill,
+	const uint8_t* boards, size_t count, double* equities);
+
+#ifdef __cplusplus
+}
+#endif
\ No newline at end of file
@@ -87,47 +87,169 @@ namespace Poker {
 	}
 
 
-	// Board
+	// OmahaHand
 
-	Board::Board(std::string board_str)
+	OmahaHand::OmahaHand(std::string hand_str) : m_size{ 0 }
 	{
-		cards.reserve(5);
+		if (hand_str.size() != 8 && hand_str.size() != 10) {
+			throw std::invalid_argument("Omaha hands hold 4 or 5 cards: " + hand_str);
+		}
 
-		for (unsigned int i = 0; i < board_str.size(); i += 2) {
-			cards.push_back(Card(board_str.substr(i, 2)));
+		for (unsigned int i = 0; i < hand_str.size(); i += 2) {
+			cards[m_size++] = Card(hand_str.substr(i, 2));
 		}
 	}
 
-	int Board::count(CardRank rank) const
+	std::string OmahaHand::repr() const
 	{
-		int count = 0;
-		for (const Card& c : cards) {
-			if (c.get_rank() == rank) {
-				count++;
+		std::string hand_str = "";
+		for (const Card& c : *this) {
+			hand_str += c.repr();
+		}
+		return hand_str;
+	}
+
+
+	// PokerRange
+
+	bool is_higher(const Card& card1, const Card& card2)
+	{
+		return card1 > card2 || (card1 == card2 && card1.get_suit() > card2.get_suit());
+	}
+
+	PokerRange::PokerRange(std::string range_str)
+	{
+		std::string::size_type start = 0;
+		while (start < range_str.size()) {
+			std::string::size_type stop = range_str.find(',', start);
+			if (stop == std::string::npos) stop = range_str.size();
+
+			std::string token;
+			for (std::string::size_type i = start; i < stop; ++i) {
+				if (range_str[i] != ' ') token += range_str[i];
+			}
+			start = stop + 1;
+			if (token.empty()) continue;
+
+			double weight = 1.0;
+			std::string::size_type colon = token.find(':');
+			if (colon != std::string::npos) {
+				weight = std::stod(token.substr(colon + 1));
+				token = token.substr(0, colon);
+			}
+
+			if (token.size() == 4 && repr_to_suit(token[1]) != CardSuit::PLACEHOLDER) {
+				add_hand(PokerHand(token), weight);
+			}
+			else {
+				add_class(token, weight);
 			}
 		}
+	}
 
-		return count;
+	void PokerRange::add_hand(const PokerHand& hand, double weight)
+	{
+		if (is_higher(hand.get_primary(), hand.get_secondary())) {
+			hands.push_back(hand);
+		}
+		else {
+			hands.push_back(PokerHand(hand.get_secondary(), hand.get_primary()));
+		}
+		weights.push_back(weight);
 	}
 
-	int Board::count(CardSuit suit) const
+	void PokerRange::add_class(std::string class_str, double weight)
 	{
-		int count = 0;
-		for (const Card& c : cards) {
-			if (c.get_suit() == suit) {
-				count++;
+		if (class_str.size() < 2 || class_str.size() > 3) {
+			throw std::invalid_argument("Invalid hand class: " + class_str);
+		}
+
+		CardRank rank1 = repr_to_rank(class_str[0]);
+		CardRank rank2 = repr_to_rank(class_str[1]);
+		bool suited = class_str.size() == 3 && class_str[2] == 's';
+		bool offsuit = class_str.size() == 3 && class_str[2] == 'o';
+
+		if (rank1 == CardRank::PLACEHOLDER || rank2 == CardRank::PLACEHOLDER) {
+			throw std::invalid_argument("Invalid hand class: " + class_str);
+		}
+
+		for (char s_1 = 0; s_1 < 4; ++s_1) {
+			for (char s_2 = 0; s_2 < 4; ++s_2) {
+				if (rank1 == rank2 && s_2 <= s_1) continue;
+				if (suited && s_1 != s_2) continue;
+				if (offsuit && s_1 == s_2) continue;
+
+				add_hand(PokerHand(rank1, static_cast<CardSuit>(s_1), rank2, static_cast<CardSuit>(s_2)), weight);
 			}
 		}
+	}
 
-		return count;
+	std::string PokerRange::repr() const
+	{
+		std::string range_str = "";
+		for (int i = 0; i < size(); ++i) {
+			if (i > 0) range_str += ",";
+			range_str += hands[i].repr();
+			if (weights[i] != 1.0) range_str += ":" + std::to_string(weights[i]);
+		}
+		return range_str;
 	}
 
-	std::string Board::repr() const
+
+	// Board
+
+	Board::Board(const std::vector<Card>& cards) : Board()
 	{
 		std::string board_str = "";
 		for (const Card& c : cards) {
 			board_str += c.repr();
 		}
+
+		if (cards.size() > capacity) {
+			throw std::invalid_argument("Board holds at most 5 cards: " + board_str);
+		}
+		for (const Card& c : cards) {
+			add_checked(c, board_str);
+		}
+	}
+
+	Board::Board(std::string_view board_str) : Board()
+	{
+		if (board_str.size() % 2 || board_str.size() > 2 * capacity) {
+			throw std::invalid_argument("Board needs up to 5 two-character cards: " + std::string(board_str));
+		}
+		for (unsigned int i = 0; i < board_str.size(); i += 2) {
+			add_checked(Card(board_str.substr(i, 2)), std::string(board_str));
+		}
+	}
+
+	void Board::add_checked(const Card& card, const std::string& board_str)
+	{
+		if (card.get_rank() == CardRank::PLACEHOLDER || card.get_suit() == CardSuit::PLACEHOLDER) {
+			throw std::invalid_argument("Invalid board card: " + board_str);
+		}
+		if (m_mask & uint64_t{ 1 } << card_bit(card)) {
+			throw std::invalid_argument("Card dealt twice: " + board_str);
+		}
+		add_card(card);
+	}
+
+	int Board::count(CardRank rank) const
+	{
+		return __builtin_popcountll((m_mask >> ((static_cast<int>(rank) - 2) * 4)) & 0xf);
+	}
+
+	int Board::count(CardSuit suit) const
+	{
+		return __builtin_popcountll(m_mask & (0x1111111111111ull << static_cast<int>(suit)));
+	}
+
+	std::string Board::repr() const
+	{
+		std::string board_str = "";
+		for (const Card& c : *this) {
+			board_str += c.repr();
+		}
 		return board_str;
 	}
 }
@@ -1,6 +1,11 @@
 #pragma once
 
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <iterator>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
 
@@ -62,7 +67,7 @@ namespace Poker {
 	public:
 		Card() : rank{ CardRank::PLACEHOLDER }, suit{ CardSuit::PLACEHOLDER } {}
 		Card(CardRank rank, CardSuit suit) : rank{ rank }, suit{ suit } {}
-		Card(std::string card_str) : rank{ repr_to_rank(card_str[0]) }, suit{ repr_to_suit(card_str[1]) } {}
+		Card(std::string_view card_str) : rank{ repr_to_rank(card_str[0]) }, suit{ repr_to_suit(card_str[1]) } {}
 
 		CardRank get_rank() const { return rank; }
 		CardSuit get_suit() const { return suit; }
@@ -92,7 +97,7 @@ namespace Poker {
 		PokerHand(Card card1, Card card2) : primary{ card1 }, secondary(card2) {}
 		PokerHand(CardRank rank1, CardSuit suit1, CardRank rank2, CardSuit suit2)
 			: primary{ Card(rank1, suit1) }, secondary{ Card(rank2, suit2) } {}
-		PokerHand(std::string hand_str) : PokerHand(Card(hand_str.substr(0, 2)), Card(hand_str.substr(2, 2))) {}
+		PokerHand(std::string_view hand_str) : PokerHand(Card(hand_str.substr(0, 2)), Card(hand_str.substr(2, 2))) {}
 
 		const Card& get_primary() const { return primary; }
 		const Card& get_secondary() const { return secondary; }
@@ -106,6 +111,52 @@ namespace Poker {
 	};
 
 
+	// OmahaHand
+
+	class OmahaHand {
+	public:
+		OmahaHand() : m_size{ 0 } {}
+		OmahaHand(std::string hand_str);
+
+		int size() const { return m_size; }
+		std::string repr() const;
+
+		const Card& operator[](int i) const { return cards[i]; }
+
+		std::array<Card, 5>::const_iterator begin() const { return cards.cbegin(); }
+		std::array<Card, 5>::const_iterator end() const { return cards.cbegin() + m_size; }
+
+	private:
+		std::array<Card, 5> cards;
+		int m_size;
+	};
+
+
+	// PokerRange
+
+	class PokerRange {
+	public:
+		PokerRange() {}
+		PokerRange(std::string range_str);
+
+		void add_hand(const PokerHand& hand, double weight = 1.0);
+		int size() const { return static_cast<int>(hands.size()); }
+		double weight(int i) const { return weights[i]; }
+		std::string repr() const;
+
+		const PokerHand& operator[](int i) const { return hands[i]; }
+
+		std::vector<PokerHand>::const_iterator begin() const { return hands.cbegin(); }
+		std::vector<PokerHand>::const_iterator end() const { return hands.cend(); }
+
+	private:
+		void add_class(std::string class_str, double weight);
+
+		std::vector<PokerHand> hands;
+		std::vector<double> weights;
+	};
+
+
 	// Street
 
 	enum class Street {
@@ -115,33 +166,56 @@ namespace Poker {
 
 	// Board
 
+	// Bit of a card in a 52-card set, (rank - 2) * 4 + suit.
+	inline int card_bit(const Card& card)
+	{
+		return (static_cast<int>(card.get_rank()) - 2) * 4 + static_cast<int>(card.get_suit());
+	}
+
+	inline Card bit_to_card(int bit)
+	{
+		return Card(static_cast<CardRank>(bit / 4 + 2), static_cast<CardSuit>(bit % 4));
+	}
+
+	// Fixed-capacity board with an inline card array and a bitmask of the cards it holds, so
+	// building, copying and querying one never allocates.
 	class Board {
 	public:
-		Board() { cards.reserve(5); }
-		Board(const std::vector<Card>& cards) : cards{ cards } {}
-		Board(const std::vector<Card>&& cards) : cards{ cards } {}
-		Board(std::string board_str);
-
-		void add_card(const Card& card) { cards.push_back(card); }
-		void pop_card() { cards.pop_back(); }
-		Street street() const { return static_cast<Street>(cards.size()); }
+		static constexpr int capacity = 5;
+
+		Board() : m_size{ 0 }, m_mask{ 0 } {}
+		// Both throw std::invalid_argument for more than five cards, an unparsed card or a duplicate.
+		Board(const std::vector<Card>& cards);
+		Board(std::string_view board_str);
+
+		// Unchecked; callers pass distinct, valid cards and stay within capacity.
+		void add_card(const Card& card)
+		{
+			assert(m_size < capacity && card.get_rank() != CardRank::PLACEHOLDER && card.get_suit() != CardSuit::PLACEHOLDER);
+			cards[m_size++] = card;
+			m_mask |= uint64_t{ 1 } << card_bit(card);
+		}
+		void pop_card() { m_mask &= ~(uint64_t{ 1 } << card_bit(cards[--m_size])); }
+		void clear() { m_size = 0; m_mask = 0; }
+		int size() const { return m_size; }
+		uint64_t mask() const { return m_mask; }
+		Street street() const { return static_cast<Street>(m_size); }
 		int count(CardRank rank) const;
-		int count(CardSuit rank) const;
+		int count(CardSuit suit) const;
 		std::string repr() const;
 
 		const Card& operator[](int i) const { return cards[i]; }
-		Card& operator[](int i) { return cards[i]; }
 
-		std::vector<Card>::iterator begin() { return cards.begin(); }
-		std::vector<Card>::iterator end() { return cards.end(); }
-		std::vector<Card>::const_iterator begin() const { return cards.cbegin(); }
-		std::vector<Card>::const_iterator end() const { return cards.cend(); }
-		std::vector<Card>::reverse_iterator rbegin() { return cards.rbegin(); }
-		std::vector<Card>::reverse_iterator rend() { return cards.rend(); }
-		std::vector<Card>::const_reverse_iterator rbegin() const { return cards.rbegin(); }
-		std::vector<Card>::const_reverse_iterator rend() const { return cards.rend(); }
+		const Card* begin() const { return cards.data(); }
+		const Card* end() const { return cards.data() + m_size; }
+		std::reverse_iterator<const Card*> rbegin() const { return std::reverse_iterator<const Card*>(end()); }
+		std::reverse_iterator<const Card*> rend() const { return std::reverse_iterator<const Card*>(begin()); }
 
 	private:
-		std::vector<Card> cards;
+		void add_checked(const Card& card, const std::string& board_str);
+
+		std::array<Card, capacity> cards;
+		int m_size;
+		uint64_t m_mask;
 	};
-}
+}
\ No newline at end of file
@@ -0,0 +1,278 @@
+#include "push_fold.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <unordered_map>
+
+namespace Poker {
+	// utility
+
+	const uint32_t equity_magic = 0x51454650;
+	// bumped whenever the class order or the equity layout changes
+	const uint32_t equity_version = 1;
+	const char class_ranks[] = "23456789TJQKA";
+
+	int combo_class(int high, int low)
+	{
+		int rank1 = high / 4;
+		int rank2 = low / 4;
+		if (rank1 < rank2) std::swap(rank1, rank2);
+
+		if (rank1 == rank2) return rank1 * 13 + rank1;
+		if (high % 4 == low % 4) return rank1 * 13 + rank2;
+		return rank2 * 13 + rank1;
+	}
+
+	// Smallest encoding of a matchup over all suit relabellings and both seat orders, 12 bits
+	// per hand with the higher card first. flipped tells whether the hero sits second in it.
+	uint32_t canonical_matchup(int hero_high, int hero_low, int vill_high, int vill_low, bool& flipped)
+	{
+		std::array<int, 4> suits = { 0, 1, 2, 3 };
+		auto relabel = [&](int card) { return card / 4 * 4 + suits[card % 4]; };
+		auto pack = [](int card1, int card2) { return static_cast<uint32_t>(std::max(card1, card2) << 6 | std::min(card1, card2)); };
+
+		uint32_t best = UINT32_MAX;
+		do {
+			uint32_t hero = pack(relabel(hero_high), relabel(hero_low));
+			uint32_t vill = pack(relabel(vill_high), relabel(vill_low));
+			if ((hero << 12 | vill) < best) {
+				best = hero << 12 | vill;
+				flipped = false;
+			}
+			if ((vill << 12 | hero) < best) {
+				best = vill << 12 | hero;
+				flipped = true;
+			}
+		} while (std::next_permutation(suits.begin(), suits.end()));
+
+		return best;
+	}
+
+	template<class Visitor>
+	void for_each_matchup(Visitor visit)
+	{
+		for (int hero_high = 1; hero_high < 52; ++hero_high) {
+			for (int hero_low = 0; hero_low < hero_high; ++hero_low) {
+				for (int vill_high = 1; vill_high < 52; ++vill_high) {
+					if (vill_high == hero_high || vill_high == hero_low) continue;
+					for (int vill_low = 0; vill_low < vill_high; ++vill_low) {
+						if (vill_low == hero_high || vill_low == hero_low) continue;
+						visit(hero_high, hero_low, vill_high, vill_low);
+					}
+				}
+			}
+		}
+	}
+
+
+	// hand classes
+
+	int hand_class(const PokerHand& hand)
+	{
+		return combo_class(card_bit(hand.get_primary()), card_bit(hand.get_secondary()));
+	}
+
+	std::string hand_class_name(int index)
+	{
+		int row = index / 13;
+		int column = index % 13;
+		if (row == column) return { class_ranks[row], class_ranks[row] };
+		if (row > column) return { class_ranks[row], class_ranks[column], 's' };
+		return { class_ranks[column], class_ranks[row], 'o' };
+	}
+
+
+	// PushFoldSolver
+
+	PushFoldSolver::PushFoldSolver(const std::string& path)
+		: equities(hand_class_count * hand_class_count, 0), weights(hand_class_count * hand_class_count, 0)
+	{
+		for_each_matchup([&](int hero_high, int hero_low, int vill_high, int vill_low) {
+			++weights[combo_class(hero_high, hero_low) * hand_class_count + combo_class(vill_high, vill_low)];
+		});
+
+		if (!load(path)) {
+			compute_equities();
+			save(path);
+		}
+	}
+
+	void PushFoldSolver::compute_equities()
+	{
+		std::unordered_map<uint32_t, int> ids;
+		std::vector<uint32_t> keys;
+		bool flipped;
+		for_each_matchup([&](int hero_high, int hero_low, int vill_high, int vill_low) {
+			uint32_t key = canonical_matchup(hero_high, hero_low, vill_high, vill_low, flipped);
+			if (ids.emplace(key, static_cast<int>(keys.size())).second) keys.push_back(key);
+		});
+
+		// the lookup engine is exact for every matchup; copies share its table across threads
+		CachedEquitySolver prototype(false, TableOptions(), EvaluatorEngine::LOOKUP);
+		std::vector<double> matchup_equities(keys.size());
+		std::atomic<size_t> cursor{ 0 };
+
+		auto work = [&] {
+			CachedEquitySolver solver(prototype);
+			for (size_t i; (i = cursor++) < keys.size();) {
+				uint32_t key = keys[i];
+				PokerHand hero(bit_to_card(key >> 18), bit_to_card(key >> 12 & 63));
+				PokerHand vill(bit_to_card(key >> 6 & 63), bit_to_card(key & 63));
+				matchup_equities[i] = solver.enumerate(hero, vill);
+			}
+		};
+
+		int threads = std::max(1u, std::thread::hardware_concurrency());
+		std::vector<std::thread> workers;
+		for (int i = 1; i < threads; ++i) workers.emplace_back(work);
+		work();
+		for (auto& worker : workers) worker.join();
+
+		std::fill(equities.begin(), equities.end(), 0.0);
+		for_each_matchup([&](int hero_high, int hero_low, int vill_high, int vill_low) {
+			double equity = matchup_equities[ids[canonical_matchup(hero_high, hero_low, vill_high, vill_low, flipped)]];
+			equities[combo_class(hero_high, hero_low) * hand_class_count + combo_class(vill_high, vill_low)] += flipped ? 1 - equity : equity;
+		});
+		for (size_t i = 0; i < equities.size(); ++i) equities[i] /= weights[i];
+	}
+
+	bool PushFoldSolver::load(const std::string& path)
+	{
+		FILE* file = std::fopen(path.c_str(), "rb");
+		if (!file) return false;
+
+		uint32_t magic = 0;
+		uint32_t version = 0;
+		uint64_t size = 0;
+		bool ok = std::fread(&magic, sizeof(magic), 1, file) == 1 && magic == equity_magic
+			&& std::fread(&version, sizeof(version), 1, file) == 1 && version == equity_version
+			&& std::fread(&size, sizeof(size), 1, file) == 1 && size == equities.size()
+			&& std::fread(equities.data(), sizeof(double), equities.size(), file) == equities.size();
+
+		std::fclose(file);
+		return ok;
+	}
+
+	void PushFoldSolver::save(const std::string& path) const
+	{
+		// a missing or read-only cache location only costs the next run a recomputation
+		FILE* file = std::fopen(path.c_str(), "wb");
+		if (!file) return;
+
+		uint64_t size = equities.size();
+		std::fwrite(&equity_magic, sizeof(equity_magic), 1, file);
+		std::fwrite(&equity_version, sizeof(equity_version), 1, file);
+		std::fwrite(&size, sizeof(size), 1, file);
+		std::fwrite(equities.data(), sizeof(double), equities.size(), file);
+		std::fclose(file);
+	}
+
+
+	// PushFoldSolver, solve
+
+	// Both players' best responses work on [class][stack] arrays, with the stack depth innermost
+	// so every matrix entry is broadcast over a contiguous run of stacks.
+	std::vector<PushFoldChart> PushFoldSolver::solve(const std::vector<double>& stacks, int iterations) const
+	{
+		const int n = hand_class_count;
+		const size_t depths = stacks.size();
+
+		// per combo pair: small blind equity, big blind equity, and the pair count itself
+		std::vector<double> sb_equity(n * n);
+		std::vector<double> bb_equity(n * n);
+		std::vector<double> totals(n, 0);
+		double total = 0;
+		for (int i = 0; i < n * n; ++i) {
+			sb_equity[i] = weights[i] * equities[i];
+			bb_equity[i] = weights[i] * (1 - equities[i]);
+			totals[i / n] += weights[i];
+			total += weights[i];
+		}
+
+		std::vector<double> push(n * depths, 1.0);
+		std::vector<double> call(n * depths, 0.5);
+		std::vector<double> push_gain(n * depths);
+		std::vector<double> call_gain(n * depths);
+		std::vector<double> first(depths);
+		std::vector<double> second(depths);
+
+		// gain of pushing over folding per small blind class, summed over combo pairs
+		auto push_gains = [&] {
+			for (int hero = 0; hero < n; ++hero) {
+				std::fill(first.begin(), first.end(), 0.0);
+				std::fill(second.begin(), second.end(), 0.0);
+				for (int vill = 0; vill < n; ++vill) {
+					const double weight = weights[hero * n + vill];
+					const double equity = sb_equity[hero * n + vill];
+					const double* calls = &call[vill * depths];
+					for (size_t d = 0; d < depths; ++d) {
+						first[d] += calls[d] * weight;
+						second[d] += calls[d] * equity;
+					}
+				}
+
+				// pushing wins the blind when folded to and 2S * equity - S when called, folding loses 0.5
+				double* gains = &push_gain[hero * depths];
+				for (size_t d = 0; d < depths; ++d) {
+					gains[d] = totals[hero] - first[d] + 2 * stacks[d] * second[d] - stacks[d] * first[d] + 0.5 * totals[hero];
+				}
+			}
+		};
+
+		// gain of calling over folding per big blind class, summed over combo pairs
+		auto call_gains = [&] {
+			for (int vill = 0; vill < n; ++vill) {
+				std::fill(first.begin(), first.end(), 0.0);
+				std::fill(second.begin(), second.end(), 0.0);
+				for (int hero = 0; hero < n; ++hero) {
+					const double weight = weights[hero * n + vill];
+					const double equity = bb_equity[hero * n + vill];
+					const double* pushes = &push[hero * depths];
+					for (size_t d = 0; d < depths; ++d) {
+						first[d] += pushes[d] * weight;
+						second[d] += pushes[d] * equity;
+					}
+				}
+
+				// calling gets 2S * equity - S, folding loses the posted blind
+				double* gains = &call_gain[vill * depths];
+				for (size_t d = 0; d < depths; ++d) {
+					gains[d] = 2 * stacks[d] * second[d] - (stacks[d] - 1) * first[d];
+				}
+			}
+		};
+
+		for (int t = 1; t <= iterations; ++t) {
+			push_gains();
+			call_gains();
+
+			double step = 1.0 / (t + 1);
+			for (size_t i = 0; i < push.size(); ++i) {
+				push[i] += ((push_gain[i] > 0 ? 1.0 : 0.0) - push[i]) * step;
+				call[i] += ((call_gain[i] > 0 ? 1.0 : 0.0) - call[i]) * step;
+			}
+		}
+
+		push_gains();
+		call_gains();
+
+		std::vector<PushFoldChart> charts(depths);
+		for (size_t d = 0; d < depths; ++d) {
+			charts[d].stack = stacks[d];
+			for (int i = 0; i < n; ++i) {
+				charts[d].push[i] = push[i * depths + d];
+				charts[d].call[i] = call[i * depths + d];
+
+				// a best response takes every positive gain; the average strategy only takes its share
+				double push_value = push_gain[i * depths + d];
+				double call_value = call_gain[i * depths + d];
+				charts[d].exploitability += std::max(push_value, 0.0) - push[i * depths + d] * push_value;
+				charts[d].exploitability += std::max(call_value, 0.0) - call[i * depths + d] * call_value;
+			}
+			charts[d].exploitability /= total;
+		}
+		return charts;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "equity.h"
+
+#include <array>
+#include <string>
+#include <vector>
+
+namespace Poker {
+	const int hand_class_count = 169;
+
+	// Index into the 13x13 starting hand grid: pairs on the diagonal, suited hands with the
+	// higher rank as the row, offsuit hands with the higher rank as the column.
+	int hand_class(const PokerHand& hand);
+	std::string hand_class_name(int index);
+
+	// Heads-up push/fold strategy at one effective stack, as push and call frequencies per class.
+	struct PushFoldChart {
+		double stack = 0;
+		std::array<double, hand_class_count> push;
+		std::array<double, hand_class_count> call;
+		// big blinds per hand the two best responses would gain against the averaged strategies
+		double exploitability = 0;
+	};
+
+	// Small blind shoves or folds, big blind calls or folds; stacks are in big blinds and the
+	// small blind posts half a big blind.
+	class PushFoldSolver {
+	public:
+		static constexpr const char* default_path = "push_fold_equity.dat";
+
+		// Reads the class-vs-class equity matrix from path, or computes it and writes it there.
+		PushFoldSolver(const std::string& path = default_path);
+
+		// Solves every stack depth together by fictitious play.
+		std::vector<PushFoldChart> solve(const std::vector<double>& stacks, int iterations = 2000) const;
+
+		// All-in equity of hero_class against vill_class, averaged over the combo pairs that don't share a card.
+		double equity(int hero_class, int vill_class) const { return equities[hero_class * hand_class_count + vill_class]; }
+		// Number of such combo pairs.
+		double weight(int hero_class, int vill_class) const { return weights[hero_class * hand_class_count + vill_class]; }
+
+	private:
+		bool load(const std::string& path);
+		void save(const std::string& path) const;
+		void compute_equities();
+
+		std::vector<double> equities;
+		std::vector<double> weights;
+	};
+}
\ No newline at end of file
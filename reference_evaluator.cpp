@@ -0,0 +1,84 @@
+#include "reference_evaluator.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace Poker {
+	// ReferenceEvaluator
+
+	template<class Variant>
+	int ReferenceEvaluator<Variant>::evaluate_five(const std::array<SlimCard, 5>& cards)
+	{
+		std::array<int, 15> counts = { 0 };
+		bool flush = true;
+		for (const SlimCard& card : cards) {
+			++counts[card.rank];
+			flush = flush && card.suit == cards[0].suit;
+		}
+
+		// (count, rank) pairs, largest group first and higher rank first within a size
+		std::array<std::pair<int, int>, 5> groups;
+		int group_count = 0;
+		for (int rank = 14; rank >= 2; --rank) {
+			if (counts[rank]) groups[group_count++] = { counts[rank], rank };
+		}
+		std::stable_sort(groups.begin(), groups.begin() + group_count,
+			[](const std::pair<int, int>& a, const std::pair<int, int>& b) { return a.first > b.first; });
+
+		int straight = 0;
+		if (group_count == 5) {
+			if (groups[0].second - groups[4].second == 4) {
+				straight = groups[0].second;
+			}
+			else if (groups[0].second == 14 && groups[1].second == Variant::min_rank + 3 && groups[4].second == Variant::min_rank) {
+				straight = Variant::min_rank + 3;
+			}
+		}
+
+		HandCategory category;
+		if (straight && flush) category = HandCategory::STRAIGHT_FLUSH;
+		else if (groups[0].first == 4) category = HandCategory::QUADS;
+		else if (groups[0].first == 3 && groups[1].first == 2) category = HandCategory::FULL_HOUSE;
+		else if (flush) category = HandCategory::FLUSH;
+		else if (straight) category = HandCategory::STRAIGHT;
+		else if (groups[0].first == 3) category = HandCategory::TRIPS;
+		else if (groups[0].first == 2 && groups[1].first == 2) category = HandCategory::TWO_PAIR;
+		else if (groups[0].first == 2) category = HandCategory::PAIR;
+		else category = HandCategory::HIGH_CARD;
+
+		int order = static_cast<int>(category);
+		if (Variant::flush_beats_full_house && category == HandCategory::FLUSH) order = static_cast<int>(HandCategory::FULL_HOUSE);
+		else if (Variant::flush_beats_full_house && category == HandCategory::FULL_HOUSE) order = static_cast<int>(HandCategory::FLUSH);
+
+		int ranks = 0;
+		if (straight) {
+			ranks = straight << 16;
+		}
+		else {
+			for (int i = 0; i < 5; ++i) {
+				ranks = ranks << 4 | (i < group_count ? groups[i].second : 0);
+			}
+		}
+		return order << 20 | ranks;
+	}
+
+	template<class Variant>
+	int ReferenceEvaluator<Variant>::evaluate(const std::array<SlimCard, 7>& cards)
+	{
+		int best = -1;
+		for (int skip1 = 0; skip1 < 7; ++skip1) {
+			for (int skip2 = skip1 + 1; skip2 < 7; ++skip2) {
+				std::array<SlimCard, 5> five;
+				int size = 0;
+				for (int i = 0; i < 7; ++i) {
+					if (i != skip1 && i != skip2) five[size++] = cards[i];
+				}
+				best = std::max(best, evaluate_five(five));
+			}
+		}
+		return best;
+	}
+
+	template class ReferenceEvaluator<Holdem>;
+	template class ReferenceEvaluator<ShortDeck>;
+}
\ No newline at end of file
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "evaluator.h"
+
+#include <array>
+
+namespace Poker {
+	// Deliberately plain evaluator to check the optimized engines against. Every five card
+	// subset is scored by grouping its ranks by count and the best of the 21 is kept; there are
+	// no tables, bit tricks or shortcuts to get wrong.
+	template<class Variant = Holdem>
+	class ReferenceEvaluator {
+	public:
+		// Higher is better; equal strengths split the pot.
+		static int evaluate(const std::array<SlimCard, 7>& cards);
+		static int evaluate_five(const std::array<SlimCard, 5>& cards);
+	};
+}
\ No newline at end of file
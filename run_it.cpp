@@ -0,0 +1,187 @@
+#include "run_it.h"
+
+#include <stdexcept>
+#include <string>
+
+namespace Poker {
+	// utility
+
+	// choose_table[n][k] for the colex ranks of live card subsets
+	struct ChooseTable {
+		ChooseTable()
+		{
+			for (int n = 0; n <= 52; ++n) {
+				values[n][0] = 1;
+				for (int k = 1; k <= 5; ++k) values[n][k] = n ? values[n - 1][k - 1] + values[n - 1][k] : 0;
+			}
+		}
+
+		std::array<std::array<int, 6>, 53> values;
+	};
+
+	const ChooseTable choose_table;
+
+	inline int choose(int n, int k)
+	{
+		return choose_table.values[n][k];
+	}
+
+
+	// RunItSolver
+
+	template<class Variant>
+	int BasicRunItSolver<Variant>::subset_rank(const char* positions, int size) const
+	{
+		int rank = 0;
+		for (int i = 0; i < size; ++i) rank += choose(positions[i], i + 1);
+		return rank;
+	}
+
+	template<class Variant>
+	void BasicRunItSolver<Variant>::score_runouts(const SuitMasks& hero, const SuitMasks& vill, std::array<char, 5>& positions, int size, int start)
+	{
+		if (size == missing) {
+			int result = BasicStrengthEvaluator<Variant>::evaluate(hero) - BasicStrengthEvaluator<Variant>::evaluate(vill);
+			char points = result > 0 ? 2 : result == 0 ? 1 : 0;
+
+			int rank = subset_rank(positions.data(), missing);
+			uint64_t mask = 0;
+			for (int i = 0; i < missing; ++i) mask |= uint64_t{ 1 } << positions[i];
+			runout_masks[rank] = mask;
+			runout_positions[rank] = positions;
+			outcomes[rank] = points;
+
+			// every nonempty subset of the runout, the runout itself included
+			for (int subset = 1; subset < (1 << missing); ++subset) {
+				std::array<char, 5> chosen;
+				int count = 0;
+				for (int i = 0; i < missing; ++i) {
+					if (subset >> i & 1) chosen[count++] = positions[i];
+				}
+				++subset_counts[count][subset_rank(chosen.data(), count)][points];
+			}
+			++subset_counts[0][0][points];
+			return;
+		}
+
+		for (int i = start; i < static_cast<int>(live.size()); ++i) {
+			positions[size] = static_cast<char>(i);
+			SuitMasks next_hero = hero;
+			SuitMasks next_vill = vill;
+			add_card(next_hero, live[i]);
+			add_card(next_vill, live[i]);
+			score_runouts(next_hero, next_vill, positions, size + 1, i + 1);
+		}
+	}
+
+	template<class Variant>
+	std::array<uint64_t, 3> BasicRunItSolver<Variant>::disjoint(const char* positions, int size) const
+	{
+		// runouts avoiding every card = sum over subsets S of the dealt cards of (-1)^|S| times the
+		// runouts holding S; subsets larger than a runout hold none
+		std::array<int64_t, 3> counts = { 0 };
+		for (int subset = 0; subset < (1 << size); ++subset) {
+			int count = __builtin_popcount(subset);
+			if (count > missing) continue;
+
+			std::array<char, 15> chosen;
+			int chosen_count = 0;
+			for (int i = 0; i < size; ++i) {
+				if (subset >> i & 1) chosen[chosen_count++] = positions[i];
+			}
+
+			const std::array<uint32_t, 3>& entry = subset_counts[count][subset_rank(chosen.data(), count)];
+			int sign = count & 1 ? -1 : 1;
+			for (int outcome = 0; outcome < 3; ++outcome) counts[outcome] += sign * static_cast<int64_t>(entry[outcome]);
+		}
+		return { static_cast<uint64_t>(counts[0]), static_cast<uint64_t>(counts[1]), static_cast<uint64_t>(counts[2]) };
+	}
+
+	template<class Variant>
+	RunItDistribution BasicRunItSolver<Variant>::enumerate(const PokerHand& hero, const PokerHand& vill, const Board& board, int runs)
+	{
+		missing = Board::capacity - board.size();
+		if (runs < 1 || runs > 3) throw std::invalid_argument("Boards can be run one to three times: " + std::to_string(runs));
+		if (!missing) throw std::invalid_argument("No cards left to run: " + board.repr());
+		if (runs == 3 && missing > 2) throw std::invalid_argument("Running three times needs at least a flop");
+
+		SuitMasks hero_masks = { 0 };
+		uint64_t dead = 0;
+		for (const Card& card : board) {
+			add_card(hero_masks, to_slim_card(card));
+			dead |= card_mask(card_to_index<Variant>(card));
+		}
+		SuitMasks vill_masks = hero_masks;
+
+		add_card(hero_masks, to_slim_card(hero.get_primary()));
+		add_card(hero_masks, to_slim_card(hero.get_secondary()));
+		add_card(vill_masks, to_slim_card(vill.get_primary()));
+		add_card(vill_masks, to_slim_card(vill.get_secondary()));
+		dead |= card_mask(card_to_index<Variant>(hero.get_primary())) | card_mask(card_to_index<Variant>(hero.get_secondary()))
+			| card_mask(card_to_index<Variant>(vill.get_primary())) | card_mask(card_to_index<Variant>(vill.get_secondary()));
+
+		live.clear();
+		for (int i = 0; i < Variant::deck_size; ++i) {
+			if (!(dead & card_mask(i))) live.push_back(index_to_slim_card<Variant>(i));
+		}
+		if (runs * missing > static_cast<int>(live.size())) throw std::invalid_argument("Not enough cards left to run " + std::to_string(runs) + " times");
+
+		int runout_count = choose(static_cast<int>(live.size()), missing);
+		runout_masks.assign(runout_count, 0);
+		runout_positions.assign(runout_count, {});
+		outcomes.assign(runout_count, 0);
+		for (int k = 0; k <= missing; ++k) subset_counts[k].assign(choose(static_cast<int>(live.size()), k), { 0, 0, 0 });
+
+		std::array<char, 5> positions;
+		score_runouts(hero_masks, vill_masks, positions, 0, 0);
+
+		// ordered deals of the earlier runs, each closed by the counts of its last run
+		std::vector<uint64_t> tallies(2 * runs + 1, 0);
+		auto close = [&](const char* dealt, int size, int points) {
+			std::array<uint64_t, 3> last = disjoint(dealt, size);
+			for (int outcome = 0; outcome < 3; ++outcome) tallies[points + outcome] += last[outcome];
+		};
+
+		if (runs == 1) {
+			close(nullptr, 0, 0);
+		}
+		for (int first = 0; runs > 1 && first < runout_count; ++first) {
+			if (runs == 2) {
+				close(runout_positions[first].data(), missing, outcomes[first]);
+				continue;
+			}
+
+			for (int second = 0; second < runout_count; ++second) {
+				if (runout_masks[first] & runout_masks[second]) continue;
+
+				// the inclusion-exclusion wants the dealt cards in ascending order
+				std::array<char, 10> dealt;
+				int size = 0;
+				for (int i = 0, j = 0; i < missing || j < missing;) {
+					if (j == missing || (i < missing && runout_positions[first][i] < runout_positions[second][j])) dealt[size++] = runout_positions[first][i++];
+					else dealt[size++] = runout_positions[second][j++];
+				}
+				close(dealt.data(), size, outcomes[first] + outcomes[second]);
+			}
+		}
+
+		RunItDistribution result;
+		result.runs = runs;
+		uint64_t total = 0;
+		for (uint64_t tally : tallies) total += tally;
+
+		double mean_square = 0;
+		for (int points = 0; points <= 2 * runs; ++points) {
+			double probability = static_cast<double>(tallies[points]) / total;
+			double share = points / (2.0 * runs);
+			result.shares.push_back(probability);
+			result.equity += probability * share;
+			mean_square += probability * share * share;
+		}
+		result.variance = mean_square - result.equity * result.equity;
+		return result;
+	}
+
+	template class BasicRunItSolver<Holdem>;
+	template class BasicRunItSolver<ShortDeck>;
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "equity.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace Poker {
+	// Pot share distribution when the rest of the board is dealt runs times from one deck.
+	struct RunItDistribution {
+		int runs = 0;
+		// shares[k] is the probability of taking k / (2 * runs) of the pot: a run won counts two,
+		// a run split counts one
+		std::vector<double> shares;
+		double equity = 0;
+		double variance = 0;
+
+		double scoop() const { return shares.empty() ? 0 : shares.back(); }
+		double lose() const { return shares.empty() ? 0 : shares.front(); }
+		double split() const { return 1 - scoop() - lose(); }
+	};
+
+	// Exact run-it-twice and three-times distributions for two hands. Each single runout is scored
+	// once, and the subsets of its cards are counted per outcome. The last run of a deal is never
+	// enumerated: the number of its runouts with each outcome that avoid the cards already dealt
+	// comes from those counts by inclusion-exclusion. So running twice costs one pass over the
+	// runouts, and three times one pass over pairs of them. Scratch buffers are kept between
+	// calls, so one solver per thread is cheapest.
+	template<class Variant>
+	class BasicRunItSolver {
+	public:
+		// Throws std::invalid_argument unless 1 <= runs <= 3 and the board has cards to come;
+		// three runs need at least a flop.
+		RunItDistribution enumerate(const PokerHand& hero, const PokerHand& vill, const Board& board, int runs = 2);
+
+	private:
+		void score_runouts(const SuitMasks& hero, const SuitMasks& vill, std::array<char, 5>& positions, int size, int start);
+		// Runouts of each outcome that share no card with the sorted positions.
+		std::array<uint64_t, 3> disjoint(const char* positions, int size) const;
+		int subset_rank(const char* positions, int size) const;
+
+		std::vector<SlimCard> live;
+		int missing = 0;
+		std::vector<uint64_t> runout_masks;
+		std::vector<std::array<char, 5>> runout_positions;
+		// half points for hero: 2 for a win, 1 for a tie
+		std::vector<char> outcomes;
+		// subset_counts[k][rank][outcome]: runouts with that outcome holding the k-subset of live cards with that colex rank
+		std::array<std::vector<std::array<uint32_t, 3>>, 6> subset_counts;
+	};
+
+	using RunItSolver = BasicRunItSolver<Holdem>;
+	using ShortDeckRunItSolver = BasicRunItSolver<ShortDeck>;
+}
\ No newline at end of file
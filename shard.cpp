@@ -0,0 +1,211 @@
+#include "shard.h"
+
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace Poker {
+	// protocol
+
+	// Both ends run on the same host, so the structs go over the socket as they are.
+	// Cards use the 0-51 index with 0xff padding the unused board slots.
+	struct ShardRequest {
+		uint8_t hero[2];
+		uint8_t vill[2];
+		uint8_t board[5];
+		uint8_t padding[7];
+		uint64_t begin;
+		uint64_t end;
+	};
+
+	struct ShardReply {
+		uint64_t wins;
+		uint64_t ties;
+		uint64_t losses;
+	};
+
+	const uint8_t no_card = 0xff;
+
+	bool send_all(int fd, const void* data, size_t bytes)
+	{
+		const char* ptr = static_cast<const char*>(data);
+		while (bytes) {
+			ssize_t sent = send(fd, ptr, bytes, MSG_NOSIGNAL);
+			if (sent <= 0) return false;
+			ptr += sent;
+			bytes -= sent;
+		}
+		return true;
+	}
+
+	bool recv_all(int fd, void* data, size_t bytes)
+	{
+		char* ptr = static_cast<char*>(data);
+		while (bytes) {
+			ssize_t received = recv(fd, ptr, bytes, 0);
+			if (received <= 0) return false;
+			ptr += received;
+			bytes -= received;
+		}
+		return true;
+	}
+
+	sockaddr_un socket_address(const std::string& path)
+	{
+		sockaddr_un address;
+		std::memset(&address, 0, sizeof(address));
+		address.sun_family = AF_UNIX;
+		if (path.size() >= sizeof(address.sun_path)) throw std::invalid_argument("Socket path too long: " + path);
+		std::memcpy(address.sun_path, path.c_str(), path.size());
+		return address;
+	}
+
+
+	// worker
+
+	void run_shard_worker(const std::string& socket_path, int connect_timeout_ms, EvaluatorEngine engine)
+	{
+		// the tables are built before connecting, so the coordinator never waits on a worker's setup
+		CachedEquitySolver solver(false, TableOptions(), engine);
+		sockaddr_un address = socket_address(socket_path);
+
+		int fd = -1;
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(connect_timeout_ms);
+		while (true) {
+			fd = socket(AF_UNIX, SOCK_STREAM, 0);
+			if (fd < 0) throw std::runtime_error("Can't create socket");
+			if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) break;
+
+			close(fd);
+			if (std::chrono::steady_clock::now() > deadline) throw std::runtime_error("Can't reach coordinator: " + socket_path);
+			std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		}
+
+		ShardRequest request;
+		while (recv_all(fd, &request, sizeof(request))) {
+			Board board;
+			for (int i = 0; i < 5 && request.board[i] != no_card; ++i) board.add_card(bit_to_card(request.board[i]));
+
+			PokerHand hero(bit_to_card(request.hero[0]), bit_to_card(request.hero[1]));
+			PokerHand vill(bit_to_card(request.vill[0]), bit_to_card(request.vill[1]));
+			ShardCounts counts = solver.enumerate(hero, vill, board, request.begin, request.end);
+
+			ShardReply reply = { counts.wins, counts.ties, counts.losses };
+			if (!send_all(fd, &reply, sizeof(reply))) break;
+		}
+
+		close(fd);
+	}
+
+
+	// ShardCoordinator
+
+	ShardCoordinator::ShardCoordinator(const std::string& socket_path) : path{ socket_path }
+	{
+		sockaddr_un address = socket_address(path);
+
+		listener = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (listener < 0) throw std::runtime_error("Can't create socket");
+
+		unlink(path.c_str());
+		if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listener, 64) != 0) {
+			close(listener);
+			throw std::runtime_error("Can't listen on " + path);
+		}
+	}
+
+	ShardCoordinator::~ShardCoordinator()
+	{
+		for (const Connection& worker : workers) close(worker.fd);
+		close(listener);
+		unlink(path.c_str());
+	}
+
+	void ShardCoordinator::accept_worker()
+	{
+		int fd = accept(listener, nullptr, nullptr);
+		if (fd >= 0) workers.push_back(Connection{ fd, -1 });
+	}
+
+	void ShardCoordinator::drop_worker(size_t index, std::vector<int>& pending)
+	{
+		if (workers[index].shard >= 0) {
+			pending.push_back(workers[index].shard);
+			++reassigned_shards;
+		}
+		close(workers[index].fd);
+		workers.erase(workers.begin() + index);
+	}
+
+	ShardCounts ShardCoordinator::enumerate(const PokerHand& hero, const PokerHand& vill, const Board& board,
+		int shard_count, int idle_timeout_ms)
+	{
+		ShardRequest request;
+		std::memset(&request, 0, sizeof(request));
+		request.hero[0] = card_bit(hero.get_primary());
+		request.hero[1] = card_bit(hero.get_secondary());
+		request.vill[0] = card_bit(vill.get_primary());
+		request.vill[1] = card_bit(vill.get_secondary());
+		for (int i = 0; i < 5; ++i) request.board[i] = i < board.size() ? card_bit(board[i]) : no_card;
+
+		// shards are handed out from the back, so pending starts reversed to go out in board order
+		uint64_t total = Holdem::board_count;
+		std::vector<int> pending;
+		for (int shard = shard_count - 1; shard >= 0; --shard) pending.push_back(shard);
+
+		ShardCounts counts;
+		int done = 0;
+		auto idle_since = std::chrono::steady_clock::now();
+
+		while (done < shard_count) {
+			for (size_t i = 0; i < workers.size() && !pending.empty();) {
+				if (workers[i].shard >= 0) {
+					++i;
+					continue;
+				}
+
+				int shard = pending.back();
+				pending.pop_back();
+				request.begin = total * shard / shard_count;
+				request.end = total * (shard + 1) / shard_count;
+				workers[i].shard = shard;
+				if (send_all(workers[i].fd, &request, sizeof(request))) ++i;
+				else drop_worker(i, pending);
+			}
+
+			if (!workers.empty()) idle_since = std::chrono::steady_clock::now();
+			else if (std::chrono::steady_clock::now() - idle_since > std::chrono::milliseconds(idle_timeout_ms)) {
+				throw std::runtime_error("No shard workers left");
+			}
+
+			std::vector<pollfd> fds = { pollfd{ listener, POLLIN, 0 } };
+			for (const Connection& worker : workers) fds.push_back(pollfd{ worker.fd, POLLIN, 0 });
+			if (poll(fds.data(), fds.size(), 100) <= 0) continue;
+
+			// walk backwards so dropping a worker doesn't shift the ones still to check
+			for (size_t i = workers.size(); i-- > 0;) {
+				if (!fds[i + 1].revents) continue;
+
+				ShardReply reply;
+				if (workers[i].shard < 0 || !recv_all(workers[i].fd, &reply, sizeof(reply))) {
+					drop_worker(i, pending);
+					continue;
+				}
+
+				counts += ShardCounts{ reply.wins, reply.ties, reply.losses };
+				workers[i].shard = -1;
+				++done;
+			}
+
+			if (fds[0].revents & POLLIN) accept_worker();
+		}
+
+		return counts;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "equity.h"
+
+#include <string>
+#include <vector>
+
+namespace Poker {
+	// Connects to the coordinator listening on socket_path and answers shard requests until
+	// the coordinator hangs up. Keeps retrying the connection for up to connect_timeout_ms.
+	// Every engine enumerates the same board table, so workers with different engines can share a job.
+	void run_shard_worker(const std::string& socket_path, int connect_timeout_ms = 30000, EvaluatorEngine engine = EvaluatorEngine::CACHED);
+
+	// Splits hand-vs-hand enumerations into board-table index shards and farms them out to
+	// worker processes over a local socket. Workers may join at any time; the shard a worker
+	// held when it disconnected goes back into the queue, so a job finishes as long as one
+	// worker is left. Counts are exact integers, so the merged result equals a local enumerate.
+	class ShardCoordinator {
+	public:
+		ShardCoordinator(const std::string& socket_path);
+		~ShardCoordinator();
+
+		ShardCoordinator(const ShardCoordinator&) = delete;
+		ShardCoordinator& operator=(const ShardCoordinator&) = delete;
+
+		// Throws std::runtime_error if no worker is connected for idle_timeout_ms while shards are left.
+		ShardCounts enumerate(const PokerHand& hero, const PokerHand& vill, const Board& board = Board(),
+			int shard_count = 64, int idle_timeout_ms = 30000);
+
+		int worker_count() const { return static_cast<int>(workers.size()); }
+		// Shards that had to be handed out again after a worker dropped, over the coordinator's lifetime.
+		int reassigned() const { return reassigned_shards; }
+
+	private:
+		struct Connection {
+			int fd;
+			int shard;
+		};
+
+		void accept_worker();
+		void drop_worker(size_t index, std::vector<int>& pending);
+
+		std::string path;
+		int listener;
+		std::vector<Connection> workers;
+		int reassigned_shards = 0;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,158 @@
+#include "table_allocator.h"
+
+#include <fstream>
+#include <string>
+
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace Poker {
+	// utility
+
+	const std::size_t small_page = 4096;
+	const std::size_t huge_page = 2 * 1024 * 1024;
+
+	const int mpol_bind = 2;
+	const int mpol_interleave = 3;
+
+	std::size_t round_up(std::size_t bytes, std::size_t alignment)
+	{
+		return (bytes + alignment - 1) / alignment * alignment;
+	}
+
+	std::size_t mapping_size(std::size_t bytes, PagePolicy pages)
+	{
+		return round_up(bytes, pages == PagePolicy::DEFAULT ? small_page : huge_page);
+	}
+
+	void* map_aligned(std::size_t bytes, std::size_t alignment)
+	{
+		void* raw = mmap(nullptr, bytes + alignment, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (raw == MAP_FAILED) return nullptr;
+
+		// trim the slack so the table starts on a huge page boundary
+		char* begin = static_cast<char*>(raw);
+		char* aligned = reinterpret_cast<char*>(round_up(reinterpret_cast<std::size_t>(begin), alignment));
+		if (aligned != begin) munmap(begin, aligned - begin);
+		char* end = aligned + bytes;
+		std::size_t tail = begin + bytes + alignment - end;
+		if (tail) munmap(end, tail);
+
+		return aligned;
+	}
+
+	void bind_memory(void* ptr, std::size_t bytes, NumaPolicy numa, int node)
+	{
+		int nodes = numa_node_count();
+		if (numa == NumaPolicy::NONE || nodes < 2) return;
+
+		unsigned long mask = 0;
+		int mode;
+		if (numa == NumaPolicy::INTERLEAVE || node < 0) {
+			mode = mpol_interleave;
+			for (int i = 0; i < nodes && i < 64; ++i) mask |= 1ul << i;
+		}
+		else {
+			mode = mpol_bind;
+			mask = 1ul << node;
+		}
+
+		// raw mbind keeps libnuma optional; failures (e.g. seccomp in containers) leave default placement
+		syscall(SYS_mbind, ptr, bytes, mode, &mask, sizeof(mask) * 8, 0);
+	}
+
+	std::string read_line(const std::string& path)
+	{
+		std::ifstream file(path);
+		std::string line;
+		std::getline(file, line);
+		return line;
+	}
+
+
+	// allocation
+
+	void* allocate_table(std::size_t bytes, PagePolicy pages, NumaPolicy numa, int node)
+	{
+		std::size_t size = mapping_size(bytes, pages);
+		void* ptr = nullptr;
+
+		if (pages == PagePolicy::EXPLICIT_HUGE) {
+			ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+			if (ptr == MAP_FAILED) ptr = nullptr;
+		}
+
+		if (!ptr && pages != PagePolicy::DEFAULT) {
+			ptr = map_aligned(size, huge_page);
+			if (ptr) madvise(ptr, size, MADV_HUGEPAGE);
+		}
+
+		if (!ptr) {
+			ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (ptr == MAP_FAILED) return nullptr;
+		}
+
+		bind_memory(ptr, size, numa, node);
+		return ptr;
+	}
+
+	void free_table(void* ptr, std::size_t bytes, PagePolicy pages)
+	{
+		if (ptr) munmap(ptr, mapping_size(bytes, pages));
+	}
+
+
+	// NUMA topology
+
+	int numa_node_count()
+	{
+		static const int count = [] {
+			int nodes = 0;
+			while (std::ifstream("/sys/devices/system/node/node" + std::to_string(nodes) + "/cpulist")) {
+				++nodes;
+			}
+			return nodes > 0 ? nodes : 1;
+		}();
+
+		return count;
+	}
+
+	int current_numa_node()
+	{
+		unsigned cpu = 0;
+		unsigned node = 0;
+		if (syscall(SYS_getcpu, &cpu, &node, nullptr) != 0) return 0;
+		return static_cast<int>(node);
+	}
+
+	bool bind_thread_to_node(int node)
+	{
+		if (node < 0 || node >= numa_node_count()) return false;
+
+		std::string cpulist = read_line("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+		if (cpulist.empty()) return false;
+
+		cpu_set_t cpus;
+		CPU_ZERO(&cpus);
+
+		std::string::size_type start = 0;
+		while (start < cpulist.size()) {
+			std::string::size_type stop = cpulist.find(',', start);
+			if (stop == std::string::npos) stop = cpulist.size();
+
+			std::string range = cpulist.substr(start, stop - start);
+			std::string::size_type dash = range.find('-');
+			int first = std::stoi(range.substr(0, dash));
+			int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+			for (int cpu = first; cpu <= last && cpu < CPU_SETSIZE; ++cpu) {
+				CPU_SET(cpu, &cpus);
+			}
+
+			start = stop + 1;
+		}
+
+		return sched_setaffinity(0, sizeof(cpus), &cpus) == 0;
+	}
+}
\ No newline at end of file
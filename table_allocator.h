@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace Poker {
+	enum class PagePolicy {
+		DEFAULT, TRANSPARENT_HUGE, EXPLICIT_HUGE
+	};
+
+	enum class NumaPolicy {
+		NONE, INTERLEAVE, REPLICATE
+	};
+
+	struct TableOptions {
+		PagePolicy pages = PagePolicy::TRANSPARENT_HUGE;
+		NumaPolicy numa = NumaPolicy::NONE;
+	};
+
+	// Every request is best effort: explicit huge pages fall back to transparent ones and
+	// NUMA placement is skipped when the kernel rejects it, so allocation only fails on OOM.
+	void* allocate_table(std::size_t bytes, PagePolicy pages, NumaPolicy numa, int node);
+	void free_table(void* ptr, std::size_t bytes, PagePolicy pages);
+
+	int numa_node_count();
+	int current_numa_node();
+	bool bind_thread_to_node(int node);
+
+
+	// TableAllocator
+
+	template<class T>
+	class TableAllocator {
+	public:
+		using value_type = T;
+
+		TableAllocator() = default;
+		TableAllocator(TableOptions options, int node = -1) : options{ options }, node{ node } {}
+		template<class U>
+		TableAllocator(const TableAllocator<U>& other) : options{ other.get_options() }, node{ other.get_node() } {}
+
+		T* allocate(std::size_t n)
+		{
+			void* ptr = allocate_table(n * sizeof(T), options.pages, options.numa, node);
+			if (!ptr) throw std::bad_alloc();
+			return static_cast<T*>(ptr);
+		}
+
+		void deallocate(T* ptr, std::size_t n) { free_table(ptr, n * sizeof(T), options.pages); }
+
+		TableOptions get_options() const { return options; }
+		int get_node() const { return node; }
+
+	private:
+		TableOptions options;
+		int node = -1;
+	};
+
+	template<class T, class U>
+	bool operator==(const TableAllocator<T>& lhs, const TableAllocator<U>& rhs)
+	{
+		return lhs.get_options().pages == rhs.get_options().pages
+			&& lhs.get_options().numa == rhs.get_options().numa
+			&& lhs.get_node() == rhs.get_node();
+	}
+
+	template<class T, class U>
+	bool operator!=(const TableAllocator<T>& lhs, const TableAllocator<U>& rhs) { return !(lhs == rhs); }
+
+	template<class T>
+	using Table = std::vector<T, TableAllocator<T>>;
+
+
+	// NumaTable
+
+	template<class T>
+	class NumaTable {
+	public:
+		NumaTable(std::size_t size, TableOptions options)
+			: options{ options }
+		{
+			int node = options.numa == NumaPolicy::REPLICATE ? 0 : -1;
+			replicas.emplace_back(size, T(), TableAllocator<T>(options, node));
+		}
+
+		std::size_t size() const { return replicas[0].size(); }
+		Table<T>& primary() { return replicas[0]; }
+
+		// Copies the primary table onto every other node. Only meaningful once it is filled.
+		void replicate()
+		{
+			if (options.numa != NumaPolicy::REPLICATE) return;
+
+			replicas.resize(1);
+			for (int node = 1; node < numa_node_count(); ++node) {
+				replicas.emplace_back(replicas[0].begin(), replicas[0].end(), TableAllocator<T>(options, node));
+			}
+		}
+
+		const Table<T>& local() const
+		{
+			if (replicas.size() == 1) return replicas[0];
+
+			int node = current_numa_node();
+			return replicas[node >= 0 && node < static_cast<int>(replicas.size()) ? node : 0];
+		}
+
+	private:
+		TableOptions options;
+		std::vector<Table<T>> replicas;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,30 @@
+#pragma once
+
+namespace Poker {
+	// Game variants are compile-time traits, so each one gets its own specialized tables,
+	// enumeration and evaluator and the hold'em path keeps its constants.
+
+	struct Holdem {
+		static constexpr int deck_size = 52;
+		static constexpr int board_count = 2'598'960;
+		static constexpr int hand_count = 1326;
+		static constexpr char min_rank = 2;
+		static constexpr bool flush_beats_full_house = false;
+	};
+
+	// 6+ hold'em: 36 cards, A-6-7-8-9 is the lowest straight and a flush beats a full house.
+	struct ShortDeck {
+		static constexpr int deck_size = 36;
+		static constexpr int board_count = 376'992;
+		static constexpr int hand_count = 630;
+		static constexpr char min_rank = 6;
+		static constexpr bool flush_beats_full_house = true;
+	};
+
+	// top rank of the straight that plays the ace low
+	template<class Variant>
+	constexpr char wheel_rank() { return Variant::min_rank + 3; }
+
+	template<class Variant>
+	constexpr int card_index(int rank, int suit) { return (rank - Variant::min_rank) * 4 + suit; }
+}
\ No newline at end of file